@@ -0,0 +1,102 @@
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "timing.hpp"
+#include "VNC.hpp"
+#include "MemoryTransport.hpp"
+#include "synthetic_session.hpp"
+
+
+// Decoder benchmark without network: replays a captured server-to-client stream (memory mapped)
+// or, without arguments, synthetic sessions of full-screen updates (one per encoding) from memory.
+
+
+static constexpr uint16_t WIDTH = 1920;
+static constexpr uint16_t HEIGHT = 1080;
+static constexpr size_t NUM_UPDATES = 20;
+
+
+// NUM_UPDATES full-screen updates in the given encoding (RAW and Zlib also with 16 bit pixels)
+std::vector<uint8_t> buildSyntheticSession(const int32_t encoding, const size_t bytesPerPixel = 4) {
+	SessionBuilder stream(WIDTH, HEIGHT, bytesPerPixel, false, 42); // stored zlib blocks: the benchmark measures the decoders, not inflate
+	stream.handshake("synthetic");
+
+	for(size_t i = 0; i < NUM_UPDATES; i++) {
+		if(encoding == 4) { // CoRRE: rects of at most 255x255
+			constexpr size_t CORRE_RECT_SIZE = 240;
+			stream.update(SessionBuilder::numTiles(WIDTH, HEIGHT, CORRE_RECT_SIZE, CORRE_RECT_SIZE));
+			for(size_t y = 0; y < HEIGHT; y += CORRE_RECT_SIZE)
+				for(size_t x = 0; x < WIDTH; x += CORRE_RECT_SIZE)
+					stream.rre(x, y, std::min<size_t>(CORRE_RECT_SIZE, WIDTH - x), std::min<size_t>(CORRE_RECT_SIZE, HEIGHT - y), true);
+			continue;
+		}
+		if(encoding == 7) { // Tight: rects of 128x128 pixels
+			stream.update(SessionBuilder::numTiles(WIDTH, HEIGHT, 128, 128));
+			stream.tightRects(0, 0, WIDTH, HEIGHT, 128, 128);
+			continue;
+		}
+
+		stream.update(1);
+		switch(encoding) {
+		case 0:  stream.raw(0, 0, WIDTH, HEIGHT); break;
+		case 2:  stream.rre(0, 0, WIDTH, HEIGHT, false); break;
+		case 5:  stream.hextile(0, 0, WIDTH, HEIGHT); break;
+		case 6:  stream.zlib(0, 0, WIDTH, HEIGHT); break;
+		case 15: stream.trle(0, 0, WIDTH, HEIGHT); break;
+		case 16: stream.zrle(0, 0, WIDTH, HEIGHT); break;
+		case 17: stream.zrle(0, 0, WIDTH, HEIGHT, true); break;
+		default:
+			throw std::runtime_error("buildSyntheticSession(): unsupported encoding " + std::to_string(encoding));
+		}
+	}
+
+	return stream.bytes;
+}
+
+template<typename Transport, typename... TransportArgs>
+void replay(const std::string& name, TransportArgs&&... transportArgs) {
+	BasicVNC<Transport> vnc(std::forward<TransportArgs>(transportArgs)...);
+	const size_t bytesTotal = vnc.transport().bytesLeft();
+
+	size_t numMessages = 0;
+	const size_t start = queryPerformanceCounter();
+	for(;;) {
+		const auto summary = vnc.recvUpdates();
+		numMessages += summary.numMessages;
+		if(!summary.budgetExhausted && !vnc.transport().dataAvailable())
+			break;
+	}
+	const double seconds = (queryPerformanceCounter() - start) * 1. / queryPerformanceFrequency();
+
+	std::cout << name << ": " << numMessages << " messages, " << bytesTotal / 1e6 << " MB in " << seconds << " s  ("
+		<< bytesTotal / 1e6 / seconds << " MB/s, " << numMessages / seconds << " messages/s)\n";
+}
+
+
+int main(int argc, char *argv[]) {
+	try {
+		if(argc == 2) {
+			replay<MappedFileTransport>(argv[1], argv[1]);
+		} else {
+			replay<MemoryTransport>("synthetic RAW session", buildSyntheticSession(0));
+			replay<MemoryTransport>("synthetic RGB565 RAW session", buildSyntheticSession(0, 2));
+			replay<MemoryTransport>("synthetic RRE session", buildSyntheticSession(2));
+			replay<MemoryTransport>("synthetic CoRRE session", buildSyntheticSession(4));
+			replay<MemoryTransport>("synthetic Hextile session", buildSyntheticSession(5));
+			replay<MemoryTransport>("synthetic Zlib session", buildSyntheticSession(6));
+			replay<MemoryTransport>("synthetic RGB565 Zlib session", buildSyntheticSession(6, 2));
+			replay<MemoryTransport>("synthetic Tight session", buildSyntheticSession(7));
+			replay<MemoryTransport>("synthetic TRLE session", buildSyntheticSession(15));
+			replay<MemoryTransport>("synthetic ZRLE session", buildSyntheticSession(16));
+			replay<MemoryTransport>("synthetic ZYWRLE session", buildSyntheticSession(17));
+		}
+	} catch(const std::exception& e) {
+		std::cout << "Exception thrown: " << e.what() << "\n";
+		return 1;
+	}
+
+	return 0;
+}
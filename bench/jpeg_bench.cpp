@@ -0,0 +1,71 @@
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <random>
+
+#include "timing.hpp"
+#include "jpeg/jpeg_decode.h"
+#include "jpeg_encode.hpp"
+
+
+// JPEG decoder benchmark: decodes a synthetic photo-like full-screen image (smooth gradients, texture, noise)
+// with the chroma subsamplings and qualities Tight servers use, and reports megapixels per second.
+
+
+static constexpr uint16_t WIDTH = 1920;
+static constexpr uint16_t HEIGHT = 1080;
+static constexpr size_t NUM_DECODES = 30;
+
+
+std::vector<uint32_t> syntheticPhoto() {
+	std::mt19937 rng(7);
+	std::vector<uint32_t> pixels(size_t(WIDTH) * HEIGHT);
+	for(size_t y = 0; y < HEIGHT; y++) {
+		for(size_t x = 0; x < WIDTH; x++) {
+			const double fx = x / double(WIDTH);
+			const double fy = y / double(HEIGHT);
+			const double texture = 40 * std::sin(x * .05 + 3 * std::sin(y * .02)) * std::cos(y * .03);
+			const auto channel = [&](const double base) { return static_cast<uint32_t>(std::clamp(base + texture + int(rng() % 16) - 8, 0., 255.)); };
+			pixels[y * WIDTH + x] = channel(60 + 150 * fx) << 16 | channel(40 + 120 * fy) << 8 | channel(200 - 120 * fx * fy);
+		}
+	}
+	return pixels;
+}
+
+void bench(const std::string& name, const std::vector<uint32_t>& image, const JpegSampling sampling, const int quality) {
+	JpegEncoder encoder;
+	const std::vector<uint8_t> jpegData = encoder.encode(image.data(), WIDTH, WIDTH, HEIGHT, sampling, quality);
+
+	jpeg::Decoder decoder;
+	std::vector<uint32_t> framebuffer(size_t(WIDTH) * HEIGHT);
+	decoder.decode(jpegData.data(), jpegData.size(), framebuffer.data(), WIDTH, WIDTH, HEIGHT); // warm up
+
+	const size_t start = queryPerformanceCounter();
+	for(size_t i = 0; i < NUM_DECODES; i++)
+		decoder.decode(jpegData.data(), jpegData.size(), framebuffer.data(), WIDTH, WIDTH, HEIGHT);
+	const double seconds = (queryPerformanceCounter() - start) * 1. / queryPerformanceFrequency();
+
+	const double megapixels = NUM_DECODES * double(WIDTH) * HEIGHT / 1e6;
+	std::cout << name << ": " << jpegData.size() / 1e3 << " kB per image, " << megapixels / seconds << " MP/s ("
+		<< NUM_DECODES / seconds << " images/s, " << NUM_DECODES * jpegData.size() / 1e6 / seconds << " MB/s compressed)\n";
+}
+
+
+int main() {
+	try {
+		const std::vector<uint32_t> image = syntheticPhoto();
+		bench("4:2:0, quality 75", image, JpegSampling::YCBCR_420, 75);
+		bench("4:2:0, quality 95", image, JpegSampling::YCBCR_420, 95);
+		bench("4:4:4, quality 75", image, JpegSampling::YCBCR_444, 75);
+		bench("4:4:4, quality 95", image, JpegSampling::YCBCR_444, 95);
+		bench("greyscale, quality 75", image, JpegSampling::GREY, 75);
+	} catch(const std::exception& e) {
+		std::cout << "Exception thrown: " << e.what() << "\n";
+		return 1;
+	}
+
+	return 0;
+}
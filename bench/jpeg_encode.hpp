@@ -0,0 +1,291 @@
+#pragma once
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+
+#include "jpeg/internal/jpeg_constants.h"
+
+
+// Minimal baseline JPEG encoder for synthesizing benchmark input: YCbCr 4:4:4 / 4:2:0 or greyscale,
+// quantization tables of ITU T.81 Annex K scaled like the IJG quality setting, the standard Huffman tables, float DCT.
+
+
+enum class JpegSampling {
+	GREY,
+	YCBCR_444,
+	YCBCR_420
+};
+
+class JpegEncoder {
+private:
+	static constexpr uint8_t LUMA_QUANT[64] { // natural order
+		16, 11, 10, 16, 24, 40, 51, 61,
+		12, 12, 14, 19, 26, 58, 60, 55,
+		14, 13, 16, 24, 40, 57, 69, 56,
+		14, 17, 22, 29, 51, 87, 80, 62,
+		18, 22, 37, 56, 68, 109, 103, 77,
+		24, 35, 55, 64, 81, 104, 113, 92,
+		49, 64, 78, 87, 103, 121, 120, 101,
+		72, 92, 95, 98, 112, 100, 103, 99,
+	};
+	static constexpr uint8_t CHROMA_QUANT[64] {
+		17, 18, 24, 47, 99, 99, 99, 99,
+		18, 21, 26, 66, 99, 99, 99, 99,
+		24, 26, 56, 99, 99, 99, 99, 99,
+		47, 66, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+	};
+
+	static constexpr uint8_t DC_LUMA_COUNTS[16] { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+	static constexpr uint8_t DC_CHROMA_COUNTS[16] { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+	static constexpr uint8_t DC_SYMBOLS[12] { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+	static constexpr uint8_t AC_LUMA_COUNTS[16] { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D };
+	static constexpr uint8_t AC_LUMA_SYMBOLS[162] {
+		0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+		0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+		0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+		0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+		0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+		0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+		0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+		0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+		0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+		0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+		0xF9, 0xFA,
+	};
+
+	static constexpr uint8_t AC_CHROMA_COUNTS[16] { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+	static constexpr uint8_t AC_CHROMA_SYMBOLS[162] {
+		0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+		0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+		0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+		0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+		0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+		0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+		0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+		0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+		0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+		0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+		0xF9, 0xFA,
+	};
+
+	struct HuffmanCode {
+		uint16_t code[256];
+		uint8_t length[256];
+
+		inline HuffmanCode(const uint8_t *const counts, const uint8_t *const symbols) {
+			uint16_t next = 0;
+			size_t index = 0;
+			for(uint8_t len = 1; len <= 16; len++, next <<= 1)
+				for(size_t i = 0; i < counts[len - 1]; i++, index++, next++) {
+					code[symbols[index]] = next;
+					length[symbols[index]] = len;
+				}
+		}
+	};
+
+	std::vector<uint8_t> out;
+	uint32_t bitBuffer = 0;
+	int numBits = 0;
+
+	uint8_t quant[2][64]; // natural order
+	const HuffmanCode dcCodes[2] { { DC_LUMA_COUNTS, DC_SYMBOLS }, { DC_CHROMA_COUNTS, DC_SYMBOLS } };
+	const HuffmanCode acCodes[2] { { AC_LUMA_COUNTS, AC_LUMA_SYMBOLS }, { AC_CHROMA_COUNTS, AC_CHROMA_SYMBOLS } };
+	float cosines[8][8];
+
+public:
+	// pixels: 32 bit BGRX with a row stride of stride pixels
+	inline std::vector<uint8_t> encode(const uint32_t *const pixels, const size_t stride, const size_t width, const size_t height, const JpegSampling sampling, const int quality) {
+		const int scale = (quality < 50) ? 5000 / quality : 200 - 2 * quality;
+		for(size_t i = 0; i < 64; i++) {
+			quant[0][i] = std::clamp((LUMA_QUANT[i] * scale + 50) / 100, 1, 255);
+			quant[1][i] = std::clamp((CHROMA_QUANT[i] * scale + 50) / 100, 1, 255);
+		}
+		for(size_t x = 0; x < 8; x++)
+			for(size_t u = 0; u < 8; u++)
+				cosines[x][u] = std::cos((2 * x + 1) * u * M_PI / 16) * ((u == 0) ? std::sqrt(.125) : .5);
+
+		const size_t numComponents = (sampling == JpegSampling::GREY) ? 1 : 3;
+		const size_t lumaFactor = (sampling == JpegSampling::YCBCR_420) ? 2 : 1;
+
+		out.clear();
+		marker(jpeg::JpegConstants::SOI);
+
+		const size_t numTables = std::min<size_t>(numComponents, 2); // luma, chroma
+
+		marker(jpeg::JpegConstants::DQT);
+		u16(2 + numTables * 65);
+		for(uint8_t table = 0; table < numTables; table++) {
+			out.push_back(table);
+			for(size_t k = 0; k < 64; k++)
+				out.push_back(quant[table][jpeg::JpegConstants::ZIGZAG[k]]);
+		}
+
+		marker(jpeg::JpegConstants::SOF0);
+		u16(8 + 3 * numComponents);
+		out.push_back(8);
+		u16(height);
+		u16(width);
+		out.push_back(numComponents);
+		for(uint8_t i = 0; i < numComponents; i++) {
+			out.push_back(i + 1);
+			out.push_back((i == 0) ? (lumaFactor << 4 | lumaFactor) : 0x11);
+			out.push_back(i == 0 ? 0 : 1);
+		}
+
+		marker(jpeg::JpegConstants::DHT);
+		u16(2 + numTables * (2 * 17 + 12 + 162));
+		for(uint8_t table = 0; table < numTables; table++) {
+			huffmanTable(0x00 | table, table ? DC_CHROMA_COUNTS : DC_LUMA_COUNTS, DC_SYMBOLS);
+			huffmanTable(0x10 | table, table ? AC_CHROMA_COUNTS : AC_LUMA_COUNTS, table ? AC_CHROMA_SYMBOLS : AC_LUMA_SYMBOLS);
+		}
+
+		marker(jpeg::JpegConstants::SOS);
+		u16(6 + 2 * numComponents);
+		out.push_back(numComponents);
+		for(uint8_t i = 0; i < numComponents; i++) {
+			out.push_back(i + 1);
+			out.push_back(i == 0 ? 0x00 : 0x11);
+		}
+		out.push_back(0); out.push_back(63); out.push_back(0);
+
+		// entropy coded data:
+		int32_t predictions[3] {};
+		const size_t mcuSize = 8 * lumaFactor;
+		float block[64];
+		for(size_t mcuY = 0; mcuY < height; mcuY += mcuSize) {
+			for(size_t mcuX = 0; mcuX < width; mcuX += mcuSize) {
+				for(size_t c = 0; c < numComponents; c++) {
+					const size_t factor = (c == 0) ? 1 : lumaFactor; // pixels per sample
+					const size_t blocks = (c == 0) ? lumaFactor : 1;
+					for(size_t by = 0; by < blocks; by++) {
+						for(size_t bx = 0; bx < blocks; bx++) {
+							for(size_t y = 0; y < 8; y++) {
+								for(size_t x = 0; x < 8; x++) { // average of factor x factor pixels, edges replicated
+									float sum = 0;
+									for(size_t sy = 0; sy < factor; sy++)
+										for(size_t sx = 0; sx < factor; sx++) {
+											const size_t px = std::min(mcuX + (bx * 8 + x) * factor + sx, width - 1);
+											const size_t py = std::min(mcuY + (by * 8 + y) * factor + sy, height - 1);
+											sum += component(pixels[py * stride + px], c);
+										}
+									block[y * 8 + x] = sum / (factor * factor) - 128;
+								}
+							}
+							encodeBlock(block, predictions[c], c == 0 ? 0 : 1);
+						}
+					}
+				}
+			}
+		}
+		flushBits();
+
+		marker(jpeg::JpegConstants::EOI);
+		return out;
+	}
+
+private:
+	static inline float component(const uint32_t pixel, const size_t c) {
+		const float r = (pixel >> 16) & 0xFF;
+		const float g = (pixel >> 8) & 0xFF;
+		const float b = pixel & 0xFF;
+		switch(c) {
+			case 0: return .299f * r + .587f * g + .114f * b;
+			case 1: return -.168736f * r - .331264f * g + .5f * b + 128;
+			default: return .5f * r - .418688f * g - .081312f * b + 128;
+		}
+	}
+
+	inline void encodeBlock(const float *const block, int32_t& prediction, const size_t table) {
+		int32_t coef[64];
+		for(size_t v = 0; v < 8; v++)
+			for(size_t u = 0; u < 8; u++) {
+				float sum = 0;
+				for(size_t y = 0; y < 8; y++)
+					for(size_t x = 0; x < 8; x++)
+						sum += block[y * 8 + x] * cosines[x][u] * cosines[y][v];
+				coef[v * 8 + u] = static_cast<int32_t>(std::lround(sum / quant[table][v * 8 + u]));
+			}
+
+		const int32_t diff = coef[0] - prediction;
+		prediction = coef[0];
+		const int dcSize = magnitude(diff);
+		bits(dcCodes[table].code[dcSize], dcCodes[table].length[dcSize]);
+		bits(valueBits(diff, dcSize), dcSize);
+
+		size_t run = 0;
+		for(size_t k = 1; k < 64; k++) {
+			const int32_t value = coef[jpeg::JpegConstants::ZIGZAG[k]];
+			if(value == 0) {
+				run++;
+				continue;
+			}
+			for(; run >= 16; run -= 16)
+				bits(acCodes[table].code[0xF0], acCodes[table].length[0xF0]);
+			const int size = magnitude(value);
+			const uint8_t symbol = run << 4 | size;
+			bits(acCodes[table].code[symbol], acCodes[table].length[symbol]);
+			bits(valueBits(value, size), size);
+			run = 0;
+		}
+		if(run > 0)
+			bits(acCodes[table].code[0x00], acCodes[table].length[0x00]); // end of block
+	}
+
+	static inline int magnitude(int32_t value) {
+		value = std::abs(value);
+		int size = 0;
+		for(; value > 0; value >>= 1)
+			size++;
+		return size;
+	}
+
+	static inline uint32_t valueBits(const int32_t value, const int size) {
+		return static_cast<uint32_t>(value < 0 ? value - 1 : value) & ((1u << size) - 1);
+	}
+
+	inline void bits(const uint32_t value, const int count) {
+		bitBuffer = bitBuffer << count | value;
+		numBits += count;
+		while(numBits >= 8) {
+			const uint8_t byte = bitBuffer >> (numBits - 8);
+			out.push_back(byte);
+			if(byte == 0xFF)
+				out.push_back(0x00); // stuffing
+			numBits -= 8;
+		}
+	}
+
+	inline void flushBits() {
+		if(numBits > 0)
+			bits(0x7F, 8 - numBits); // pad with ones
+		bitBuffer = 0;
+	}
+
+	inline void marker(const uint8_t type) {
+		out.push_back(0xFF);
+		out.push_back(type);
+	}
+
+	inline void u16(const uint16_t v) {
+		out.push_back(v >> 8);
+		out.push_back(v);
+	}
+
+	inline void huffmanTable(const uint8_t classAndId, const uint8_t *const counts, const uint8_t *const symbols) {
+		out.push_back(classAndId);
+		size_t numSymbols = 0;
+		for(size_t i = 0; i < 16; i++) {
+			out.push_back(counts[i]);
+			numSymbols += counts[i];
+		}
+		out.insert(out.end(), symbols, symbols + numSymbols);
+	}
+};
@@ -0,0 +1,579 @@
+#pragma once
+
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+
+#include "compression/deflate_compress.h"
+#include "jpeg_encode.hpp"
+
+
+// Synthetic server-to-client RFB streams for the decode benchmark and the tests. Every rect is written together with
+// what it has to decode to, so a decoded session can be checked pixel by pixel.
+
+
+class SessionBuilder {
+public:
+	static constexpr uint8_t UNCHECKED = 255; // tolerance of pixels whose decoded value is not modelled (ZYWRLE tiles)
+	static constexpr uint8_t JPEG_TOLERANCE = 24; // per colour component, for the photo-like rects at quality 75 (at most 19 seen)
+
+	std::vector<uint8_t> bytes;
+	const uint16_t width, height;
+	const size_t bytesPerPixel; // server format: 32 bpp BGRX, or 16 bpp RGB565
+	const bool compressZlib; // zlib data as fixed-code DEFLATE blocks (every third one stored), otherwise stored blocks only
+	std::mt19937 rng;
+
+	// framebuffer (blue | green << 8 | red << 16) after everything written so far, and the error allowed per colour component
+	std::vector<uint32_t> expected;
+	std::vector<uint8_t> tolerance;
+	std::vector<uint32_t> expectedCursor; // CursorShape::pixels of the latest cursor rect
+
+private:
+	// zlib streams of the encodings (ZRLE and ZYWRLE share one):
+	bool zlibStarted = false;
+	bool zrleStarted = false;
+	bool tightStarted[4] {};
+
+	std::vector<uint32_t> trlePalette; // of the previous TRLE tile
+	uint32_t hextileBackground = 0;
+
+public:
+	inline SessionBuilder(const uint16_t width, const uint16_t height, const size_t bytesPerPixel, const bool compressZlib, const uint32_t seed):
+			width(width),
+			height(height),
+			bytesPerPixel(bytesPerPixel),
+			compressZlib(compressZlib),
+			rng(seed),
+			expected(size_t(width) * height, 0),
+			tolerance(size_t(width) * height, 0) { }
+
+	inline void u8(const uint8_t v) { bytes.push_back(v); }
+	inline void u16(const uint16_t v) { u8(v >> 8); u8(v); }
+	inline void u32(const uint32_t v) { u16(v >> 16); u16(v); }
+	inline void append(const std::vector<uint8_t>& data) { bytes.insert(bytes.end(), data.begin(), data.end()); }
+
+	inline void handshake(const std::string& name) {
+		const std::string version = "RFB 003.008\n";
+		bytes.insert(bytes.end(), version.begin(), version.end());
+		u8(1); u8(1); // one security type: None
+		u32(0); // SecurityResult: OK
+
+		u16(width); u16(height);
+		if(bytesPerPixel == 2) {
+			u8(16); u8(16); u8(0); u8(1); // bpp, depth, big endian, true colour
+			u16(31); u16(63); u16(31); // max
+			u8(11); u8(5); u8(0); // shift
+		} else {
+			u8(32); u8(24); u8(0); u8(1);
+			u16(255); u16(255); u16(255);
+			u8(16); u8(8); u8(0);
+		}
+		u8(0); u8(0); u8(0); // padding
+		u32(name.size());
+		bytes.insert(bytes.end(), name.begin(), name.end());
+	}
+
+	inline void update(const uint16_t numRects) {
+		u8(0); u8(0); // FramebufferUpdate, padding
+		u16(numRects);
+	}
+
+	inline void rectHeader(const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h, const int32_t encoding) {
+		u16(x); u16(y); u16(w); u16(h); u32(encoding);
+	}
+
+	static inline size_t numTiles(const size_t w, const size_t h, const size_t tileWidth, const size_t tileHeight) {
+		return ((w + tileWidth - 1) / tileWidth) * ((h + tileHeight - 1) / tileHeight);
+	}
+
+
+	// ---- pixels ----
+
+	// a pixel of the server's format: a few colours (so that the compressors find matches), now and then a random one
+	inline uint32_t color() {
+		return (rng() % 4 == 0) ? rng() : 0x203040u * (1 + rng() % 3);
+	}
+
+	// pixel, CPIXEL (ZRLE / TRLE) and TPIXEL (Tight) of the server's format, into out
+	inline void pixel(std::vector<uint8_t>& out, const uint32_t c) const { for(size_t i = 0; i < bytesPerPixel; i++) out.push_back(c >> 8 * i); }
+	inline void cpixel(std::vector<uint8_t>& out, const uint32_t c) const { for(size_t i = 0; i < std::min<size_t>(bytesPerPixel, 3); i++) out.push_back(c >> 8 * i); }
+	inline void tpixel(std::vector<uint8_t>& out, const uint32_t c) const {
+		if(bytesPerPixel == 2) pixel(out, c);
+		else out.push_back(c >> 16), out.push_back(c >> 8), out.push_back(c);
+	}
+
+	// framebuffer pixel of a pixel of the server's format (the padding byte of 32 bpp pixels is not compared)
+	inline uint32_t expand(const uint32_t c) const {
+		if(bytesPerPixel == 4)
+			return c & 0xFFFFFF;
+		const uint32_t red = c >> 11 & 31, green = c >> 5 & 63, blue = c & 31;
+		return (blue << 3 | blue >> 2) | (green << 2 | green >> 4) << 8 | (red << 3 | red >> 2) << 16;
+	}
+
+	inline void paint(const size_t x, const size_t y, const size_t w, const size_t h, const uint32_t c) {
+		const uint32_t value = expand(c);
+		for(size_t j = y; j < y + h; j++) {
+			std::fill_n(expected.begin() + j * width + x, w, value);
+			std::fill_n(tolerance.begin() + j * width + x, w, 0);
+		}
+	}
+
+	// pixel pos of a w pixels wide tile, in raster order
+	inline void paintAt(const size_t x, const size_t y, const size_t w, const size_t pos, const uint32_t c) {
+		paint(x + pos % w, y + pos / w, 1, 1, c);
+	}
+
+	inline void markUnchecked(const size_t x, const size_t y, const size_t w, const size_t h) {
+		for(size_t j = y; j < y + h; j++)
+			std::fill_n(tolerance.begin() + j * width + x, w, UNCHECKED);
+	}
+
+
+	// ---- zlib ----
+
+	// next piece of a zlib stream, ending at a byte boundary (sync flush)
+	inline std::vector<uint8_t> zlibPiece(const std::vector<uint8_t>& data, bool& streamStarted) const {
+		if(!compressZlib) { // stored blocks
+			std::vector<uint8_t> out;
+			if(!streamStarted)
+				out.push_back(0x78), out.push_back(0x01);
+			streamStarted = true;
+
+			for(size_t off = 0; off < data.size(); off += 65535) {
+				const uint16_t len = std::min<size_t>(65535, data.size() - off);
+				out.push_back(0x00); // BFINAL = 0, BTYPE = 00
+				out.push_back(len); out.push_back(len >> 8);
+				out.push_back(~len); out.push_back(~len >> 8);
+				out.insert(out.end(), data.begin() + off, data.begin() + off + len);
+			}
+			return out;
+		}
+
+		Bitstream out;
+		if(!streamStarted)
+			out.pushNum(0x78, 8), out.pushNum(0x01, 8);
+		streamStarted = true;
+
+		for(size_t off = 0, i = 0; off < data.size(); off += 500, i++) { // blocks of at most 500 input bytes
+			const size_t len = std::min<size_t>(500, data.size() - off);
+			if(i % 3 == 2) {
+				out.pushBit(0); out.pushNum(0, 2);
+				out.flushBits();
+				out.pushNum(len, 16); out.pushNum(~len, 16);
+				for(size_t j = 0; j < len; j++) out.pushNum(data[off + j], 8);
+			} else {
+				deflate::deflateCompressedBlock(data.data() + off, len, out, deflate::DeflateType::FIXED, false);
+			}
+		}
+
+		out.pushBit(0); out.pushNum(0, 2); // empty stored block
+		out.flushBits();
+		out.pushNum(0, 16); out.pushNum(0xFFFF, 16);
+		return out.buffer();
+	}
+
+
+	// ---- rects (header and payload) ----
+
+	inline void raw(const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) {
+		rectHeader(x, y, w, h, 0);
+		for(size_t p = 0; p < size_t(w) * h; p++) {
+			const uint32_t c = color();
+			pixel(bytes, c);
+			paintAt(x, y, w, p, c);
+		}
+	}
+
+	inline void copyRect(const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h, const uint16_t srcX, const uint16_t srcY) {
+		rectHeader(x, y, w, h, 1);
+		u16(srcX); u16(srcY);
+
+		std::vector<uint32_t> pixels, tolerances;
+		for(size_t j = 0; j < h; j++) {
+			pixels.insert(pixels.end(), expected.begin() + (srcY + j) * width + srcX, expected.begin() + (srcY + j) * width + srcX + w);
+			tolerances.insert(tolerances.end(), tolerance.begin() + (srcY + j) * width + srcX, tolerance.begin() + (srcY + j) * width + srcX + w);
+		}
+		for(size_t j = 0; j < h; j++) {
+			std::copy_n(pixels.begin() + j * w, w, expected.begin() + (y + j) * width + x);
+			std::copy_n(tolerances.begin() + j * w, w, tolerance.begin() + (y + j) * width + x);
+		}
+	}
+
+	// RRE / CoRRE (at most 255x255): a few large subrects anywhere in the rect, then per 8x16 character cell three thin strokes (like a terminal)
+	inline void rre(const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h, const bool compact) {
+		constexpr size_t NUM_LARGE = 4;
+		rectHeader(x, y, w, h, compact ? 4 : 2);
+		u32(NUM_LARGE + (w / 8) * (h / 16) * 3);
+
+		const uint32_t background = color();
+		pixel(bytes, background);
+		paint(x, y, w, h, background);
+
+		const auto subrect = [&](const size_t subX, const size_t subY, const size_t subW, const size_t subH) {
+			const uint32_t c = color();
+			pixel(bytes, c);
+			if(compact) { u8(subX); u8(subY); u8(subW); u8(subH); }
+			else { u16(subX); u16(subY); u16(subW); u16(subH); }
+			paint(x + subX, y + subY, subW, subH, c);
+		};
+
+		for(size_t i = 0; i < NUM_LARGE; i++) {
+			const size_t subW = 1 + rng() % w, subH = 1 + rng() % h;
+			subrect(rng() % (w - subW + 1), rng() % (h - subH + 1), subW, subH);
+		}
+		for(size_t cellY = 0; cellY + 16 <= h; cellY += 16) {
+			for(size_t cellX = 0; cellX + 8 <= w; cellX += 8) {
+				for(size_t i = 0; i < 3; i++) {
+					const bool vertical = rng() % 2;
+					const size_t subW = vertical ? 1 + rng() % 2 : 2 + rng() % 6;
+					const size_t subH = vertical ? 4 + rng() % 12 : 1 + rng() % 2;
+					subrect(cellX + rng() % (9 - subW), cellY + rng() % (17 - subH), subW, subH);
+				}
+			}
+		}
+	}
+
+	// Hextile, cycling through raw, solid, background-only (carried over), monochrome and coloured subrect tiles
+	inline void hextile(const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) {
+		rectHeader(x, y, w, h, 5);
+
+		size_t tileIndex = 0;
+		for(size_t tileY = y; tileY < size_t(y) + h; tileY += 16) {
+			for(size_t tileX = x; tileX < size_t(x) + w; tileX += 16, tileIndex++) {
+				const size_t tileW = std::min<size_t>(16, x + w - tileX);
+				const size_t tileH = std::min<size_t>(16, y + h - tileY);
+				const auto subrect = [&](const uint32_t c) { // x, y | width - 1, height - 1 (inside the tile)
+					const size_t subX = rng() % tileW, subY = rng() % tileH;
+					const size_t subW = 1 + rng() % (tileW - subX), subH = 1 + rng() % (tileH - subY);
+					u8(subX << 4 | subY);
+					u8((subW - 1) << 4 | (subH - 1));
+					paint(tileX + subX, tileY + subY, subW, subH, c);
+				};
+
+				switch(tileIndex % 5) {
+				case 0: // raw
+					u8(1);
+					for(size_t p = 0; p < tileW * tileH; p++) {
+						const uint32_t c = color();
+						pixel(bytes, c);
+						paintAt(tileX, tileY, tileW, p, c);
+					}
+					break;
+				case 1: // solid
+					u8(2);
+					hextileBackground = color();
+					pixel(bytes, hextileBackground);
+					paint(tileX, tileY, tileW, tileH, hextileBackground);
+					break;
+				case 2: // previous background
+					u8(0);
+					paint(tileX, tileY, tileW, tileH, hextileBackground);
+					break;
+				case 3: { // background, foreground, 8 subrects
+					u8(2 | 4 | 8);
+					hextileBackground = color();
+					const uint32_t foreground = color();
+					pixel(bytes, hextileBackground); pixel(bytes, foreground);
+					paint(tileX, tileY, tileW, tileH, hextileBackground);
+					u8(8);
+					for(size_t i = 0; i < 8; i++) subrect(foreground);
+				} break;
+				case 4: // 8 coloured subrects on the previous background
+					u8(8 | 16);
+					paint(tileX, tileY, tileW, tileH, hextileBackground);
+					u8(8);
+					for(size_t i = 0; i < 8; i++) {
+						const uint32_t c = color();
+						pixel(bytes, c);
+						subrect(c);
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	// RAW pixels in the Zlib encoding's stream
+	inline void zlib(const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) {
+		rectHeader(x, y, w, h, 6);
+		std::vector<uint8_t> pixels;
+		for(size_t p = 0; p < size_t(w) * h; p++) {
+			const uint32_t c = color();
+			pixel(pixels, c);
+			paintAt(x, y, w, p, c);
+		}
+		const std::vector<uint8_t> zlibData = zlibPiece(pixels, zlibStarted);
+		u32(zlibData.size());
+		append(zlibData);
+	}
+
+	inline void trle(const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) {
+		rectHeader(x, y, w, h, 15);
+		append(rleTiles(x, y, w, h, 16, 15));
+	}
+
+	// ZRLE, or ZYWRLE (every tile a wavelet transformed one; its pixels are not modelled, so they are marked unchecked)
+	inline void zrle(const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h, const bool zywrle = false) {
+		const int32_t encoding = zywrle ? 17 : 16;
+		rectHeader(x, y, w, h, encoding);
+		const std::vector<uint8_t> zlibData = zlibPiece(rleTiles(x, y, w, h, 64, encoding), zrleStarted);
+		u32(zlibData.size());
+		append(zlibData);
+	}
+
+	// Tight rects of rectW x rectH pixels covering an area (numTiles() of them), cycling through fill, copy, mono / 8 colour palette,
+	// gradient and (32 bpp only) JPEG rects; each basic subencoding on its own zlib stream, the first basic rect resets its stream
+	inline void tightRects(const uint16_t x0, const uint16_t y0, const uint16_t w, const uint16_t h, const size_t rectW, const size_t rectH) {
+		const auto compactLength = [&](const size_t len) {
+			u8((len & 0x7F) | (len >= 0x80 ? 0x80 : 0));
+			if(len >= 0x80) u8((len >> 7 & 0x7F) | (len >= 0x4000 ? 0x80 : 0));
+			if(len >= 0x4000) u8(len >> 14);
+		};
+
+		// photo-like tile for the JPEG rects (4:2:0, quality 75)
+		std::vector<uint32_t> photo(rectW * rectH);
+		for(size_t i = 0; i < photo.size(); i++) {
+			const uint32_t level = ((i % rectW + i / rectW) * 2 + rng() % 8) & 0xFF;
+			photo[i] = level << 16 | (255 - level) << 8 | (level / 2 + 64);
+		}
+
+		const size_t numKinds = (bytesPerPixel == 4) ? 6 : 5;
+		size_t rectIndex = 0;
+		for(size_t y = y0; y < size_t(y0) + h; y += rectH) {
+			for(size_t x = x0; x < size_t(x0) + w; x += rectW, rectIndex++) {
+				const size_t rw = std::min<size_t>(rectW, x0 + w - x);
+				const size_t rh = std::min<size_t>(rectH, y0 + h - y);
+				rectHeader(x, y, rw, rh, 7);
+
+				const size_t kind = rectIndex % numKinds;
+				if(kind == 0) { // fill
+					const uint32_t c = color();
+					u8(0x80);
+					tpixel(bytes, c);
+					paint(x, y, rw, rh, c);
+					continue;
+				}
+				if(kind == 5) { // JPEG
+					const std::vector<uint8_t> jpegData = JpegEncoder().encode(photo.data(), rectW, rw, rh, JpegSampling::YCBCR_420, 75);
+					u8(0x90);
+					compactLength(jpegData.size());
+					append(jpegData);
+					for(size_t j = 0; j < rh; j++) {
+						std::copy_n(photo.begin() + j * rectW, rw, expected.begin() + (y + j) * width + x);
+						std::fill_n(tolerance.begin() + (y + j) * width + x, rw, JPEG_TOLERANCE);
+					}
+					continue;
+				}
+
+				const size_t streamId = kind - 1;
+				uint8_t control = streamId << 4;
+				if(rectIndex == streamId + 1) { // first basic rect of its kind: reset
+					control |= 1 << streamId;
+					tightStarted[streamId] = false;
+				}
+
+				std::vector<uint8_t> data;
+				if(kind == 1) { // copy
+					u8(control);
+					for(size_t p = 0; p < rw * rh; p++) {
+						const uint32_t c = color();
+						tpixel(data, c);
+						paintAt(x, y, rw, p, c);
+					}
+				} else if(kind == 2 || kind == 3) { // mono / 8 colour palette
+					const size_t numColors = (kind == 2) ? 2 : 8;
+					std::vector<uint32_t> palette(numColors);
+					u8(control | 0x40); u8(1); u8(numColors - 1);
+					for(uint32_t& c : palette) {
+						c = color();
+						tpixel(bytes, c);
+					}
+
+					if(numColors == 2) { // 1 bit per pixel, msb first, rows start at byte boundaries
+						data.resize(rh * ((rw + 7) / 8));
+						for(uint8_t& byte : data) byte = rng() % 2 ? 0xF0 : rng();
+						for(size_t j = 0; j < rh; j++)
+							for(size_t i = 0; i < rw; i++)
+								paint(x + i, y + j, 1, 1, palette[(data[j * ((rw + 7) / 8) + i / 8] >> (7 - i % 8)) & 1]);
+					} else {
+						data.resize(rw * rh);
+						for(uint8_t& byte : data) byte = rng() % numColors;
+						for(size_t p = 0; p < rw * rh; p++)
+							paintAt(x, y, rw, p, palette[data[p]]);
+					}
+				} else { // gradient
+					u8(control | 0x40); u8(2);
+					gradient(data, x, y, rw, rh);
+				}
+
+				if(data.size() < 12) { // too small to compress; sent as is
+					append(data);
+					continue;
+				}
+				const std::vector<uint8_t> zlibData = zlibPiece(data, tightStarted[streamId]);
+				compactLength(zlibData.size());
+				append(zlibData);
+			}
+		}
+	}
+
+	// Cursor pseudo-encoding: pixels, then the mask (rows padded to whole bytes, msb first)
+	inline void cursor(const uint16_t w, const uint16_t h) {
+		rectHeader(rng() % w, rng() % h, w, h, -239);
+		expectedCursor.assign(size_t(w) * h, 0);
+		for(size_t p = 0; p < size_t(w) * h; p++) {
+			const uint32_t c = color();
+			pixel(bytes, c);
+			expectedCursor[p] = expand(c);
+		}
+		for(size_t j = 0; j < h; j++) {
+			for(size_t i = 0; i < w; i += 8) {
+				const uint8_t mask = rng();
+				u8(mask);
+				for(size_t bit = 0; bit < 8 && i + bit < w; bit++)
+					expectedCursor[j * w + i + bit] = (mask & (0x80 >> bit)) ? expectedCursor[j * w + i + bit] | 0xFF000000 : 0;
+			}
+		}
+	}
+
+private:
+	// run length of ZRLE / TRLE: 255 for each full 255, then the rest
+	static inline void runLength(std::vector<uint8_t>& out, size_t run) {
+		for(run -= 1; run >= 255; run -= 255)
+			out.push_back(255);
+		out.push_back(run);
+	}
+
+	// tile data of a ZRLE / TRLE rect, cycling through raw, solid, packed palette, plain RLE and palette RLE tiles
+	// (TRLE additionally: both kinds of palette reuse; ZYWRLE: raw tiles announce a transformed palette RLE tile)
+	inline std::vector<uint8_t> rleTiles(const size_t x0, const size_t y0, const size_t w, const size_t h, const size_t tileSize, const int32_t encoding) {
+		std::vector<uint8_t> tiles;
+		const auto newPalette = [&](const size_t size) {
+			trlePalette.resize(size);
+			for(uint32_t& c : trlePalette) {
+				c = color();
+				cpixel(tiles, c);
+			}
+		};
+		const auto paletteRuns = [&](const size_t x, const size_t y, const size_t tileW, const size_t tileH) {
+			for(size_t pos = 0; pos < tileW * tileH; ) {
+				const size_t run = std::min<size_t>(1 + rng() % 300, tileW * tileH - pos);
+				const size_t index = rng() % trlePalette.size();
+				if(run == 1) {
+					tiles.push_back(index);
+				} else {
+					tiles.push_back(0x80 | index);
+					runLength(tiles, run);
+				}
+				for(const size_t end = pos + run; pos < end; pos++)
+					paintAt(x, y, tileW, pos, trlePalette[index]);
+			}
+		};
+		const auto packedPixels = [&](const size_t x, const size_t y, const size_t tileW, const size_t tileH, const size_t bits, const uint8_t byteMask) {
+			const size_t rowBytes = (tileW * bits + 7) / 8;
+			for(size_t j = 0; j < tileH; j++) {
+				for(size_t b = 0; b < rowBytes; b++) {
+					const uint8_t byte = rng() & byteMask;
+					tiles.push_back(byte);
+					for(size_t i = b * 8 / bits; i < std::min(tileW, (b + 1) * 8 / bits); i++) // msb first
+						paint(x + i, y + j, 1, 1, trlePalette[(byte >> (8 - bits - (i * bits) % 8)) & ((1 << bits) - 1)]);
+				}
+			}
+		};
+
+		const size_t numKinds = (encoding == 15) ? 7 : 5;
+		size_t tileIndex = 0;
+		for(size_t y = y0; y < y0 + h; y += tileSize) {
+			for(size_t x = x0; x < x0 + w; x += tileSize, tileIndex++) {
+				const size_t tileW = std::min<size_t>(tileSize, x0 + w - x);
+				const size_t tileH = std::min<size_t>(tileSize, y0 + h - y);
+
+				if(encoding == 17) { // ZYWRLE: transformed tile, coefficients as palette RLE
+					tiles.push_back(0);
+					tiles.push_back(128 + 8);
+					newPalette(8);
+					paletteRuns(x, y, tileW, tileH);
+					markUnchecked(x, y, tileW, tileH);
+					continue;
+				}
+
+				switch(tileIndex % numKinds) {
+				case 0: // raw
+					tiles.push_back(0);
+					for(size_t p = 0; p < tileW * tileH; p++) {
+						const uint32_t c = color();
+						cpixel(tiles, c);
+						paintAt(x, y, tileW, p, c);
+					}
+					break;
+				case 1: { // solid
+					const uint32_t c = color();
+					tiles.push_back(1);
+					cpixel(tiles, c);
+					paint(x, y, tileW, tileH, c);
+				} break;
+				case 2: // packed palette, 4 colours
+					tiles.push_back(4);
+					newPalette(4);
+					packedPixels(x, y, tileW, tileH, 2, 0xFF);
+					break;
+				case 3: // plain RLE
+					tiles.push_back(128);
+					for(size_t pos = 0; pos < tileW * tileH; ) {
+						const size_t run = std::min<size_t>(1 + rng() % 300, tileW * tileH - pos);
+						const uint32_t c = color();
+						cpixel(tiles, c);
+						runLength(tiles, run);
+						for(const size_t end = pos + run; pos < end; pos++)
+							paintAt(x, y, tileW, pos, c);
+					}
+					break;
+				case 4: // palette RLE, 8 colours
+					tiles.push_back(128 + 8);
+					newPalette(8);
+					paletteRuns(x, y, tileW, tileH);
+					break;
+				case 5: // packed palette of the previous tile (8 colours: 4 bits per index)
+					tiles.push_back(127);
+					packedPixels(x, y, tileW, tileH, 4, 0x77);
+					break;
+				case 6: // palette RLE with the palette of the previous tile
+					tiles.push_back(129);
+					paletteRuns(x, y, tileW, tileH);
+					break;
+				}
+			}
+		}
+		return tiles;
+	}
+
+	// differences to the prediction (left + above - above left, clamped) per colour component, as the gradient filter of Tight sends them
+	inline void gradient(std::vector<uint8_t>& data, const size_t x, const size_t y, const size_t w, const size_t h) {
+		const int maxes[3] = { (bytesPerPixel == 4) ? 255 : 31, (bytesPerPixel == 4) ? 255 : 63, (bytesPerPixel == 4) ? 255 : 31 }; // red, green, blue
+		std::vector<int> above(w * 3, 0), current(w * 3, 0);
+		for(size_t j = 0; j < h; j++, std::swap(above, current)) {
+			for(size_t i = 0; i < w; i++) {
+				int difference[3];
+				for(size_t c = 0; c < 3; c++) {
+					difference[c] = rng() % 4;
+					const int left = (i > 0) ? current[(i - 1) * 3 + c] : 0;
+					const int aboveLeft = (i > 0) ? above[(i - 1) * 3 + c] : 0;
+					const int prediction = std::clamp(left + above[i * 3 + c] - aboveLeft, 0, maxes[c]);
+					current[i * 3 + c] = (prediction + difference[c]) & maxes[c];
+				}
+
+				const int* const v = &current[i * 3];
+				if(bytesPerPixel == 4) {
+					data.push_back(difference[0]); data.push_back(difference[1]); data.push_back(difference[2]);
+					paint(x + i, y + j, 1, 1, v[0] << 16 | v[1] << 8 | v[2]);
+				} else {
+					pixel(data, difference[0] << 11 | difference[1] << 5 | difference[2]);
+					paint(x + i, y + j, 1, 1, v[0] << 11 | v[1] << 5 | v[2]);
+				}
+			}
+		}
+	}
+};
@@ -0,0 +1,228 @@
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "timing.hpp"
+#include "Socket.hpp"
+#include "UringSocket.hpp"
+#include "InProcessPipe.hpp"
+#include "EmulatedLink.hpp"
+
+
+// Transport throughput benchmark: every transport consumes the same synthetic stream of single-rect ZRLE FramebufferUpdates.
+//  - loopback TCP: blocking Socket::recvExactly path, Socket::recvChunk, io_uring zero-copy chunks
+//  - unix domain socket (Socket::recvChunk)
+//  - in-process pipe (zero-copy chunks)
+//  - in-process pipe behind an emulated WAN link (latency, jitter, bandwidth cap, fragmented reads)
+
+
+static constexpr size_t PAYLOAD_SIZE = 48 * 1024; // zlib data per rect
+static constexpr size_t MESSAGES_PER_BATCH = 64;
+
+
+// builds MESSAGES_PER_BATCH FramebufferUpdate messages with one ZRLE rect each
+std::vector<uint8_t> buildSyntheticStream() {
+	std::vector<uint8_t> stream;
+	std::mt19937 rng(1234);
+
+	const auto pushU16 = [&](const uint16_t v) { stream.push_back(v >> 8); stream.push_back(v); };
+	const auto pushU32 = [&](const uint32_t v) { pushU16(v >> 16); pushU16(v); };
+
+	for(size_t i = 0; i < MESSAGES_PER_BATCH; i++) {
+		stream.push_back(0); // FramebufferUpdate
+		stream.push_back(0); // padding
+		pushU16(1); // number of rects
+		pushU16(0); pushU16(0); pushU16(256); pushU16(256); // position / size
+		pushU32(16); // ZRLE
+		pushU32(PAYLOAD_SIZE);
+		for(size_t j = 0; j < PAYLOAD_SIZE; j++)
+			stream.push_back(rng());
+	}
+
+	return stream;
+}
+
+// writes the stream until totalBytes were sent
+template<typename Write>
+void produce(const std::vector<uint8_t>& stream, const size_t totalBytes, Write write) {
+	for(size_t sent = 0; sent < totalBytes; sent += stream.size())
+		write(stream.data(), stream.size());
+}
+
+// accepts one client and writes the stream to it
+void serve(const int listener, const std::vector<uint8_t>& stream, const size_t totalBytes) {
+	const int client = accept(listener, nullptr, nullptr);
+	if(client < 0)
+		throw std::runtime_error("accept failed");
+
+	produce(stream, totalBytes, [&](const uint8_t* data, const size_t size) {
+		for(size_t off = 0; off < size; ) {
+			const ssize_t res = ::send(client, data + off, size - off, MSG_NOSIGNAL);
+			if(res <= 0)
+				return;
+			off += res;
+		}
+	});
+
+	close(client);
+}
+
+uint64_t consumeBlocking(const Socket& sock, const size_t numMessages) {
+	uint64_t checksum = 0;
+	std::vector<uint8_t> payload;
+
+	for(size_t i = 0; i < numMessages; i++) {
+		sock.recvU8(); sock.recvU8(); // type + padding
+		const uint16_t numRects = sock.recvU16();
+		for(size_t r = 0; r < numRects; r++) {
+			for(size_t j = 0; j < 4; j++) sock.recvU16();
+			sock.recvS32();
+
+			payload.resize(sock.recvU32());
+			sock.recvExactly(payload.data(), payload.size());
+			for(const uint8_t byte : payload)
+				checksum += byte;
+		}
+	}
+
+	return checksum;
+}
+
+template<typename Transport>
+uint64_t consumeChunked(const Transport& sock, const size_t numMessages) {
+	uint64_t checksum = 0;
+
+	for(size_t i = 0; i < numMessages; i++) {
+		sock.recvU8(); sock.recvU8(); // type + padding
+		const uint16_t numRects = sock.recvU16();
+		for(size_t r = 0; r < numRects; r++) {
+			for(size_t j = 0; j < 4; j++) sock.recvU16();
+			sock.recvS32();
+
+			for(size_t left = sock.recvU32(); left > 0; ) {
+				const auto [data, len] = sock.recvChunk(left);
+				for(size_t j = 0; j < len; j++)
+					checksum += data[j];
+				left -= len;
+			}
+		}
+	}
+
+	return checksum;
+}
+
+template<typename Transport, typename Consume>
+void measure(const std::string& name, const Transport& sock, const std::vector<uint8_t>& stream, const size_t totalBytes, Consume consume) {
+	const size_t numMessages = (totalBytes + stream.size() - 1) / stream.size() * MESSAGES_PER_BATCH;
+
+	const size_t start = queryPerformanceCounter();
+	const uint64_t checksum = consume(sock, numMessages);
+	const double seconds = (queryPerformanceCounter() - start) * 1. / queryPerformanceFrequency();
+
+	const double megabytes = numMessages * (stream.size() / MESSAGES_PER_BATCH) / 1e6;
+	std::cout << name << ": " << megabytes / seconds << " MB/s  (" << megabytes << " MB in " << seconds << " s, checksum " << checksum << ")" << std::endl;
+}
+
+template<typename Transport, typename Consume>
+void runTcpBenchmark(const std::string& name, const std::vector<uint8_t>& stream, const size_t totalBytes, Consume consume) {
+	const int listener = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in addr {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t addrLen = sizeof(addr);
+	if(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listener, 1) < 0
+			|| getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &addrLen) < 0)
+		throw std::runtime_error("could not create loopback listener");
+
+	std::thread server(serve, listener, std::cref(stream), totalBytes);
+
+	Transport sock("127.0.0.1", ntohs(addr.sin_port));
+	measure(name, sock, stream, totalBytes, consume);
+
+	sock.close();
+	server.join();
+	close(listener);
+}
+
+template<typename Consume>
+void runUnixBenchmark(const std::string& name, const std::vector<uint8_t>& stream, const size_t totalBytes, Consume consume) {
+	const std::string path = "/tmp/bvnc_transport_bench_" + std::to_string(getpid()) + ".sock";
+
+	const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	sockaddr_un addr {};
+	addr.sun_family = AF_UNIX;
+	memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+	unlink(path.c_str());
+	if(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listener, 1) < 0)
+		throw std::runtime_error("could not create unix socket listener");
+
+	std::thread server(serve, listener, std::cref(stream), totalBytes);
+
+	Socket sock(path);
+	measure(name, sock, stream, totalBytes, consume);
+
+	sock.close();
+	server.join();
+	close(listener);
+	unlink(path.c_str());
+}
+
+template<typename Transport, typename Consume, typename... TransportArgs>
+void runPipeBenchmark(const std::string& name, const std::vector<uint8_t>& stream, const size_t totalBytes, Consume consume, TransportArgs&&... transportArgs) {
+	auto [clientEnd, server] = InProcessPipe::create();
+
+	std::thread producer([&, server = std::move(server)]() {
+		try {
+			produce(stream, totalBytes, [&](const uint8_t* data, const size_t size) { server.send(data, size); });
+		} catch(const std::exception&) { } // client closed early
+		server.close();
+	});
+
+	const Transport client(std::forward<TransportArgs>(transportArgs)..., std::move(clientEnd));
+	measure(name, client, stream, totalBytes, consume);
+
+	client.close();
+	producer.join();
+}
+
+
+int main(int argc, char *argv[]) {
+	const size_t totalMegabytes = (argc >= 2) ? std::stoul(argv[1]) : 1024;
+	const size_t totalBytes = totalMegabytes * 1024 * 1024;
+
+	try {
+		const std::vector<uint8_t> stream = buildSyntheticStream();
+
+		runTcpBenchmark<Socket>("TCP loopback  Socket      recvExactly", stream, totalBytes, consumeBlocking);
+		runTcpBenchmark<Socket>("TCP loopback  Socket      recvChunk  ", stream, totalBytes, consumeChunked<Socket>);
+		runTcpBenchmark<UringSocket>("TCP loopback  UringSocket recvChunk  ", stream, totalBytes, consumeChunked<UringSocket>);
+		runUnixBenchmark("unix socket   Socket      recvChunk  ", stream, totalBytes, consumeChunked<Socket>);
+		runPipeBenchmark<InProcessPipe>("in-process    InProcessPipe recvChunk", stream, totalBytes, consumeChunked<InProcessPipe>);
+
+		LinkConditions wan;
+		wan.latencyUs = 20000;
+		wan.jitterUs = 5000;
+		wan.bytesPerSecond = 50 * 1000 * 1000 / 8; // 50 Mbit/s
+		wan.minReadSize = 1;
+		wan.maxReadSize = 4096;
+		wan.seed = 1;
+		runPipeBenchmark<EmulatedLink<InProcessPipe>>("emulated WAN  InProcessPipe recvChunk", stream, std::min<size_t>(totalBytes, 16 * 1024 * 1024), consumeChunked<EmulatedLink<InProcessPipe>>, wan);
+	} catch(const std::exception& e) {
+		std::cout << "Exception thrown: " << e.what() << "\n";
+		return 1;
+	}
+
+	return 0;
+}
@@ -58,21 +58,59 @@ void eraseChar(const uint32_t c) {
 // </initialize keyboardvariables>
 
 
-void runVNC(const std::string& address, const uint16_t port) {
-	VNC vnc(address, port);
-
+void runVNC(VNC& vnc) {
 	GDIWindow window(800, 800);
 
 	static constexpr size_t TARGET_FRAMERATE = 100;
+	static constexpr double BACKGROUND_FRAMERATE = 2; // while another window has the focus
+	static constexpr double SLOW_LINK = 2e6; // bytes / second; below: 16 bpp (half the bytes, barely visible loss)
 	const size_t perfFreq = queryPerformanceFrequency();
 	size_t lastUpdateRequestTime = 0;
 
+	vnc.setUpdatePacing(2, TARGET_FRAMERATE); // keep up to two requests in flight to hide the round trip
+	vnc.setAdaptiveEncodings(true); // pick the encoding that is cheapest on this link / machine
+	vnc.enableContinuousUpdates(); // if the server supports it: streamed updates, requests only while the link is congested
+	const WireFormat fullFormat = vnc.pixelFormat();
+	size_t lastStatsTime = 0;
+	bool refreshReported = false;
+
+	VNC::UpdateBudget updateBudget;
+	updateBudget.maxSeconds = .5 / TARGET_FRAMERATE; // leave the rest of the frame for drawing
+
+	// per window column / row: first of the two texels to filter and their bilinear weights
+	struct TexCoord {
+		bool inside;
+		size_t tex0;
+		double weight0;
+		double weight1;
+	};
+	std::vector<TexCoord> texColumns;
+	std::vector<TexCoord> texRows;
+	size_t texWindowWidth = 0;
+	size_t texWindowHeight = 0;
+	bool framebufferResized = true;
+	vnc.setResizeCallback([&](uint16_t, uint16_t) { framebufferResized = true; }); // rebuild scaling tables instead of reconnecting
+
 	while(!window.shouldClose()) {
 		window.pollMsg();
 
 		window.graphics.clear(0x00000000);
 
-		vnc.recvUpdates();
+		// nobody looks at a minimized viewer, and hardly at one in the background; spare the server the encoding work:
+		const bool minimized = IsIconic(window.win.wnd);
+		if(minimized)
+			vnc.suspendUpdates();
+		else if(GetForegroundWindow() != window.win.wnd)
+			vnc.restrictUpdates(0, 0, vnc.width(), vnc.height(), BACKGROUND_FRAMERATE);
+		else
+			vnc.resumeUpdates(); // refreshes the framebuffer after a suspension
+
+		vnc.recvUpdates(updateBudget); // drain everything that queued up since the last frame
+
+		if(minimized) {
+			Sleep(50); // nothing to draw
+			continue;
+		}
 
 		const size_t t = queryPerformanceCounter();
 		const double dt_update = (t - lastUpdateRequestTime) * 1. / perfFreq; // Zeit seit letzter Update-request
@@ -81,9 +119,22 @@ void runVNC(const std::string& address, const uint16_t port) {
 			lastUpdateRequestTime = t;
 		}
 
-		// send FrameBufferUpdateRequest:
-		if(sendUpdateNow) {
-			vnc.sendUpdateRequest(0, 0, vnc.width(), vnc.height());
+		if(!refreshReported && !vnc.refreshing()) {
+			refreshReported = true;
+			std::cout << "First frame: pointer area after " << vnc.timeToFirstPixels() * 1000 << " ms, complete after " << vnc.timeToFullFrame() * 1000 << " ms\n";
+		}
+
+		if((t - lastStatsTime) > perfFreq * 5) {
+			lastStatsTime = t;
+			std::cout << "RTT: " << vnc.rtt() * 1000 << " ms  update rate: " << vnc.updateRate() << " / s"
+				<< "  continuous: " << std::boolalpha << vnc.continuousUpdates() << "  fence latency: " << vnc.fenceLatency() * 1000 << " ms"
+				<< "  bandwidth: " << vnc.bandwidth() / 1e6 << " MB/s\n";
+
+			const double capacity = vnc.linkCapacity(); // 4x apart, so the format does not flap
+			if(capacity > 0 && capacity < SLOW_LINK)
+				vnc.setPixelFormat(WireFormat::RGB565);
+			else if(capacity > 4 * SLOW_LINK)
+				vnc.setPixelFormat(fullFormat);
 		}
 
 
@@ -104,6 +155,29 @@ void runVNC(const std::string& address, const uint16_t port) {
 		const size_t x2 = window.width - marginX / 2;
 		const size_t y2 = window.height - marginY / 2;
 
+		if(framebufferResized || window.width != texWindowWidth || window.height != texWindowHeight) {
+			const auto buildTexCoords = [](std::vector<TexCoord>& coords, const size_t windowSize, const size_t lo, const size_t hi, const size_t texSize) {
+				coords.resize(windowSize);
+				for(size_t i = 0; i < windowSize; i++) {
+					const double texNorm = (i - lo) * 1. / (hi - lo);
+					coords[i].inside = texNorm >= 0. && texNorm < 1.;
+					if(!coords[i].inside)
+						continue;
+
+					const double texSmooth = texNorm * texSize;
+					coords[i].tex0 = std::min<size_t>(floorl(texSmooth), texSize - 2);
+					coords[i].weight0 = 1. - fabsl(texSmooth - coords[i].tex0);
+					coords[i].weight1 = 1. - fabsl(texSmooth - (coords[i].tex0 + 1));
+				}
+			};
+			buildTexCoords(texColumns, window.width, x1, x2, vnc.width());
+			buildTexCoords(texRows, window.height, y1, y2, vnc.height());
+
+			texWindowWidth = window.width;
+			texWindowHeight = window.height;
+			framebufferResized = false;
+		}
+
 		POINT clientRectOrig {};
 		ClientToScreen(window.win.wnd, &clientRectOrig);
 		RECT windowRect;
@@ -122,7 +196,13 @@ void runVNC(const std::string& address, const uint16_t port) {
 			if(mouseXRemote < vnc.width() && mouseYRemote < vnc.height())
 				vnc.sendPointerEvent(mouseXRemote, mouseYRemote, right << 2 | middle << 1 | left);
 		}
+
+		if(mouseXRemote < vnc.width() && mouseYRemote < vnc.height())
+			vnc.setRefreshFocus(mouseXRemote, mouseYRemote); // the first frame fills in around the pointer
 		// </handle mouse updates>
+
+		// send FrameBufferUpdateRequest (paced by the RTT-aware scheduler):
+		vnc.requestUpdates();
 		
 
 		// <send key updates>
@@ -184,35 +264,41 @@ void runVNC(const std::string& address, const uint16_t port) {
 		}
 		// </send key updates>
 
+		// colour map mode: the framebuffer holds 8 bit indices, expanded through the colour map here
+		const uint32_t *const fbPixels = reinterpret_cast<const uint32_t*>(vnc.pixel_data());
+		const uint8_t *const fbIndices = vnc.pixel_data();
+		const std::array<uint32_t, 256>& colorMap = vnc.colorMap();
+		const bool indexed = vnc.indexedColor();
+		const auto texel = [&](const size_t index) { return indexed ? colorMap[fbIndices[index]] : fbPixels[index]; };
+
 		for(size_t y = 0; y < window.height; y++) {
+			const TexCoord& texRow = texRows[y];
+
 			for(size_t x = 0; x < window.width; x++) {
-				const double xTexNorm = (x - x1) * 1. / (x2 - x1);
-				const double yTexNorm = (y - y1) * 1. / (y2 - y1);
+				const TexCoord& texColumn = texColumns[x];
 
 				uint32_t& pixel = window.graphics.buffer[y * window.width + x];
 
-				if(xTexNorm < 0. || xTexNorm >= 1.) {
+				if(!texColumn.inside) {
 					pixel = 0x00000000; // Pixel rechts und links auf schwarz setzen
 					continue;
 				}
 
-				if(yTexNorm < 0. || yTexNorm >= 1.) {
+				if(!texRow.inside) {
 					pixel = 0x00000000; // Pixel oben und unten auf schwarz setzen
 					continue;
 				}
 
 				// <bilinear filtering>
-				const double xTexSmooth = xTexNorm * vnc.width();
-				const double yTexSmooth = yTexNorm * vnc.height();
-				const size_t xTex0 = std::min<size_t>(floorl(xTexSmooth), vnc.width() - 2);
-				const size_t yTex0 = std::min<size_t>(floorl(yTexSmooth), vnc.height() - 2);
+				const size_t xTex0 = texColumn.tex0;
+				const size_t yTex0 = texRow.tex0;
 				const size_t xTex1 = xTex0 + 1;
 				const size_t yTex1 = yTex0 + 1;
 
-				const double xTexWeight0 = 1. - fabsl(xTexSmooth - xTex0);
-				const double xTexWeight1 = 1. - fabsl(xTexSmooth - xTex1);
-				const double yTexWeight0 = 1. - fabsl(yTexSmooth - yTex0);
-				const double yTexWeight1 = 1. - fabsl(yTexSmooth - yTex1);
+				const double xTexWeight0 = texColumn.weight0;
+				const double xTexWeight1 = texColumn.weight1;
+				const double yTexWeight0 = texRow.weight0;
+				const double yTexWeight1 = texRow.weight1;
 
 				const double texWeight00 = yTexWeight0 * xTexWeight0;
 				const double texWeight01 = yTexWeight0 * xTexWeight1;
@@ -224,10 +310,10 @@ void runVNC(const std::string& address, const uint16_t port) {
 				const uint32_t texIndex10 = yTex1 * vnc.width() + xTex0;
 				const uint32_t texIndex11 = yTex1 * vnc.width() + xTex1;
 
-				const uint32_t pixel00 = reinterpret_cast<uint32_t*>(vnc.pixel_data())[texIndex00];
-				const uint32_t pixel01 = reinterpret_cast<uint32_t*>(vnc.pixel_data())[texIndex01];
-				const uint32_t pixel10 = reinterpret_cast<uint32_t*>(vnc.pixel_data())[texIndex10];
-				const uint32_t pixel11 = reinterpret_cast<uint32_t*>(vnc.pixel_data())[texIndex11];
+				const uint32_t pixel00 = texel(texIndex00);
+				const uint32_t pixel01 = texel(texIndex01);
+				const uint32_t pixel10 = texel(texIndex10);
+				const uint32_t pixel11 = texel(texIndex11);
 
 				constexpr auto red   = [](const uint32_t col) -> double { return static_cast<uint8_t>(col >> 16) / 255.; };
 				constexpr auto green = [](const uint32_t col) -> double { return static_cast<uint8_t>(col >> 8) / 255.; };
@@ -266,10 +352,9 @@ void runVNC(const std::string& address, const uint16_t port) {
 			}
 		}
 
-		window.graphics.setPixel(winMouseX, winMouseY, 0x00FF00FF);
-		window.graphics.setPixel(winMouseX+1, winMouseY, 0x00FF00FF);
-		window.graphics.setPixel(winMouseX, winMouseY+1, 0x00FF00FF);
-		window.graphics.setPixel(winMouseX+1, winMouseY+1, 0x00FF00FF);
+		// the server leaves the cursor out of the framebuffer (Cursor pseudo-encoding); draw its shape at the local pointer, unscaled:
+		if(const CursorShape* cursor = vnc.cursor(); cursor && mouseXRemote < vnc.width() && mouseYRemote < vnc.height())
+			cursor->composite(window.graphics.buffer, window.width, window.height, static_cast<ptrdiff_t>(winMouseX), static_cast<ptrdiff_t>(winMouseY));
 
 		window.updateScreen();
 	}
@@ -282,17 +367,29 @@ void runVNC(const std::string& address, const uint16_t port) {
 int main(int argc, char *argv[]) {
 	if(argc != 2 && argc != 3) {
 		std::cout << "Usage: bvnc <address> [port]\n";
+		std::cout << "       bvnc unix:<socket path>\n";
 		return 1;
 	}
 
 	try {
 		const std::string address = argv[1];
-		const uint16_t port = (argc == 3) ? std::stoul(argv[2]) : 5900;
 
-		std::cout << "Address: " << address << "\n";
-		std::cout << "Port: " << port << "\n";
+		static const std::string UNIX_PREFIX = "unix:";
+		if(address.compare(0, UNIX_PREFIX.size(), UNIX_PREFIX) == 0) {
+			const std::string path = address.substr(UNIX_PREFIX.size());
+			std::cout << "Unix socket: " << path << "\n";
+
+			VNC vnc(path);
+			runVNC(vnc);
+		} else {
+			const uint16_t port = (argc == 3) ? std::stoul(argv[2]) : 5900;
 
-		runVNC(address, port);
+			std::cout << "Address: " << address << "\n";
+			std::cout << "Port: " << port << "\n";
+
+			VNC vnc(address, port);
+			runVNC(vnc);
+		}
 	} catch(const std::exception& e) {
 		std::cout << "Exception thrown: " << e.what() << "\n";
 	}
@@ -1,165 +1,240 @@
-#pragma once
-
-
-#include <stdexcept>
-#include <iostream>
-#include <cstdint>
-#include <vector>
-#include <string>
-
-
-class BitstreamReader; // lightweight wrapper for reading from Bitstreams
-
-
-class Bitstream {
-	friend class BitstreamReader;
-
-private:
-	std::vector<uint8_t> data;
-	uint8_t numBitsUsed; // how many bits of the last byte are populated
-
-public:
-	inline Bitstream():
-			data{},
-			numBitsUsed(8) {
-	}
-
-	inline Bitstream(const std::vector<uint8_t>& data):
-			data(data),
-			numBitsUsed(8) {
-	}
-
-	inline Bitstream(std::vector<uint8_t>&& data):
-			data(std::move(data)),
-			numBitsUsed(8) {
-	}
-
-	inline Bitstream(const std::string& hex):
-			data(hex.size() / 2),
-			numBitsUsed(8) {
-
-		if(hex.size() % 2 != 0)
-			throw std::runtime_error("Bitstream: Cant decode incomplete hex string.");
-
-		for(size_t i = 0; i < hex.size() / 2; i++)
-			data[i] = hexToNibble(hex[i*2]) << 4 | hexToNibble(hex[i*2 + 1]);
-	}
-
-public:
-	// push single Bit into stream (and flush if neccessary):
-	inline void pushBit(const uint8_t bit) {
-		if(numBitsUsed == 8)
-			data.push_back(0), numBitsUsed = 0;
-		data[data.size()-1] |= bit << (numBitsUsed++);
-	};
-
-	// flush any unflushed bits into stream:
-	inline void flushBits() {
-		numBitsUsed = 8;
-	};
-
-	// push number into stream:
-	inline void pushNum(size_t num, size_t numBits) {
-		for(size_t i = 0; i < numBits; i++)
-			pushBit((num >> i) & 0x1);
-	};
-
-	// push anything that is not a number into stream:
-	inline void pushCode(size_t num, size_t numBits) { // bit-order opposite of numbers
-		for(size_t i = 0; i < numBits; i++)
-			pushBit((num >> (numBits - 1 - i)) & 0x1);
-	};
-
-
-	inline const std::vector<uint8_t>& buffer() const {
-		return data;
-	}
-public:
-
-	friend inline std::ostream& operator<<(std::ostream& cout, const Bitstream& stream) {
-		for(const uint8_t& byte : stream.data)
-			for(uint8_t bit = 0; bit < 8; bit++)
-				cout << (((byte >> bit) & 0x1) ? '1' : '0');
-		return cout;
-	}
-
-	inline std::string toHexString() const {
-		std::string out;
-		for(const uint8_t& byte : data) {
-			out += nibbleToHex(byte >> 4); // high nibble
-			out += nibbleToHex(byte & 0xF); // low nibble
-		}
-		return out;
-	}
-
-private:
-	static inline uint8_t hexToNibble(const char hex) {
-		if(hex >= '0' && hex <= '9') return 0 + hex - '0';
-		if(hex >= 'A' && hex <= 'F') return 10 + hex - 'A';
-		if(hex >= 'a' && hex <= 'f') return 10 + hex - 'a';
-		return -1;
-	};
-
-	static inline char nibbleToHex(const uint8_t nibble) {
-		constexpr char HEX[] {
-			'0', '1', '2', '3', '4', '5', '6', '7',
-			'8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
-		return HEX[nibble];
-	}
-};
-
-// -----------------------------   ####################################   ------------------------------
-
-class AbstractBitStreamReader {
-public:
-	inline virtual uint8_t readBit() = 0;
-	inline virtual void flushBits() = 0;
-
-	// read number from stream:
-	inline size_t readNum(size_t numBits) {
-		size_t num = 0;
-		for(size_t i = 0; i < numBits; i++)
-			num |= readBit() << i;
-		return num;
-	};
-};
-
-class BitstreamReader : public AbstractBitStreamReader {
-private:
-public: // TODO: remove
-	const Bitstream& source;
-	size_t numBytesRead;
-	uint8_t numBitsRead; // number of bits in current byte, that have already been read
-
-public:
-	inline BitstreamReader(const Bitstream& source):
-		source(source), numBytesRead(0), numBitsRead(0) { }
-
-public:
-	inline virtual uint8_t readBit() override {
-		if(numBytesRead >= source.data.size()) throw std::runtime_error("BitstreamReader::readBit(): out of data");
-		const uint8_t targetByte = source.data[numBytesRead];
-		const uint8_t bit = (targetByte >> numBitsRead) & 0x1;
-		numBitsRead++;
-		if(numBitsRead == 8) {
-			numBytesRead++;
-			numBitsRead = 0;
-		}
-		return bit;
-	}
-
-	// skip any unread bits of current byte:
-	inline virtual void flushBits() override {
-		if(numBitsRead > 0) {
-			numBitsRead = 0;
-			numBytesRead++;
-		}
-	};
-
-	inline bool isEmpty() const {
-		const bool empty = numBytesRead >= source.data.size();
-		if(empty && numBitsRead) throw std::runtime_error("AAAAAAAAAAAAAAAAAA");
-		return empty;
-		// return numBytesRead >= source.data.size();
-	}
+#pragma once
+
+
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+#include <vector>
+#include <string>
+
+
+class BitstreamReader; // lightweight wrapper for reading from Bitstreams
+
+
+class Bitstream {
+	friend class BitstreamReader;
+
+private:
+	std::vector<uint8_t> data;
+	uint8_t numBitsUsed; // how many bits of the last byte are populated
+
+public:
+	inline Bitstream():
+			data{},
+			numBitsUsed(8) {
+	}
+
+	inline Bitstream(const std::vector<uint8_t>& data):
+			data(data),
+			numBitsUsed(8) {
+	}
+
+	inline Bitstream(std::vector<uint8_t>&& data):
+			data(std::move(data)),
+			numBitsUsed(8) {
+	}
+
+	inline Bitstream(const std::string& hex):
+			data(hex.size() / 2),
+			numBitsUsed(8) {
+
+		if(hex.size() % 2 != 0)
+			throw std::runtime_error("Bitstream: Cant decode incomplete hex string.");
+
+		for(size_t i = 0; i < hex.size() / 2; i++)
+			data[i] = hexToNibble(hex[i*2]) << 4 | hexToNibble(hex[i*2 + 1]);
+	}
+
+public:
+	// push single Bit into stream (and flush if neccessary):
+	inline void pushBit(const uint8_t bit) {
+		if(numBitsUsed == 8)
+			data.push_back(0), numBitsUsed = 0;
+		data[data.size()-1] |= bit << (numBitsUsed++);
+	};
+
+	// flush any unflushed bits into stream:
+	inline void flushBits() {
+		numBitsUsed = 8;
+	};
+
+	// push number into stream:
+	inline void pushNum(size_t num, size_t numBits) {
+		for(size_t i = 0; i < numBits; i++)
+			pushBit((num >> i) & 0x1);
+	};
+
+	// push anything that is not a number into stream:
+	inline void pushCode(size_t num, size_t numBits) { // bit-order opposite of numbers
+		for(size_t i = 0; i < numBits; i++)
+			pushBit((num >> (numBits - 1 - i)) & 0x1);
+	};
+
+
+	inline const std::vector<uint8_t>& buffer() const {
+		return data;
+	}
+public:
+
+	friend inline std::ostream& operator<<(std::ostream& cout, const Bitstream& stream) {
+		for(const uint8_t& byte : stream.data)
+			for(uint8_t bit = 0; bit < 8; bit++)
+				cout << (((byte >> bit) & 0x1) ? '1' : '0');
+		return cout;
+	}
+
+	inline std::string toHexString() const {
+		std::string out;
+		for(const uint8_t& byte : data) {
+			out += nibbleToHex(byte >> 4); // high nibble
+			out += nibbleToHex(byte & 0xF); // low nibble
+		}
+		return out;
+	}
+
+private:
+	static inline uint8_t hexToNibble(const char hex) {
+		if(hex >= '0' && hex <= '9') return 0 + hex - '0';
+		if(hex >= 'A' && hex <= 'F') return 10 + hex - 'A';
+		if(hex >= 'a' && hex <= 'f') return 10 + hex - 'a';
+		return -1;
+	};
+
+	static inline char nibbleToHex(const uint8_t nibble) {
+		constexpr char HEX[] {
+			'0', '1', '2', '3', '4', '5', '6', '7',
+			'8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+		return HEX[nibble];
+	}
+};
+
+// -----------------------------   ####################################   ------------------------------
+
+class AbstractBitStreamReader {
+public:
+	inline virtual uint8_t readBit() = 0;
+	inline virtual void flushBits() = 0;
+
+	// read number from stream:
+	inline size_t readNum(size_t numBits) {
+		size_t num = 0;
+		for(size_t i = 0; i < numBits; i++)
+			num |= readBit() << i;
+		return num;
+	};
+};
+
+class BitstreamReader : public AbstractBitStreamReader {
+private:
+public: // TODO: remove
+	const Bitstream& source;
+	size_t numBytesRead;
+	uint8_t numBitsRead; // number of bits in current byte, that have already been read
+
+public:
+	inline BitstreamReader(const Bitstream& source):
+		source(source), numBytesRead(0), numBitsRead(0) { }
+
+public:
+	inline virtual uint8_t readBit() override {
+		if(numBytesRead >= source.data.size()) throw std::runtime_error("BitstreamReader::readBit(): out of data");
+		const uint8_t targetByte = source.data[numBytesRead];
+		const uint8_t bit = (targetByte >> numBitsRead) & 0x1;
+		numBitsRead++;
+		if(numBitsRead == 8) {
+			numBytesRead++;
+			numBitsRead = 0;
+		}
+		return bit;
+	}
+
+	// skip any unread bits of current byte:
+	inline virtual void flushBits() override {
+		if(numBitsRead > 0) {
+			numBitsRead = 0;
+			numBytesRead++;
+		}
+	};
+
+	inline bool isEmpty() const {
+		const bool empty = numBytesRead >= source.data.size();
+		if(empty && numBitsRead) throw std::runtime_error("AAAAAAAAAAAAAAAAAA");
+		return empty;
+		// return numBytesRead >= source.data.size();
+	}
+};
+
+// -----------------------------   ####################################   ------------------------------
+
+/**
+ * Reads a fixed number of bytes as bitstream directly out of the chunks handed out by Source
+ * (Source::recvChunk(maxLen) -> std::pair<const uint8_t*, size_t>), without collecting them in a buffer first.
+ * Reading past the end throws; outOfData() then tells that apart from a decoding error (the data may just be incomplete).
+*/
+template<typename Source>
+class ChunkedBitstreamReader : public AbstractBitStreamReader {
+private:
+	const Source& source;
+	const size_t numBytes;
+	size_t numBytesLeft; // bytes that have not been fetched from source yet
+	const uint8_t* current;
+	const uint8_t* end;
+	uint8_t numBitsRead; // number of bits in current byte, that have already been read
+	bool exhausted;
+
+public:
+	inline ChunkedBitstreamReader(const Source& source, const size_t numBytes):
+		source(source), numBytes(numBytes), numBytesLeft(numBytes), current(nullptr), end(nullptr), numBitsRead(0), exhausted(false) { }
+
+public:
+	inline virtual uint8_t readBit() override {
+		if(current == end)
+			fetch();
+		const uint8_t bit = (*current >> numBitsRead) & 0x1;
+		numBitsRead++;
+		if(numBitsRead == 8) {
+			current++;
+			numBitsRead = 0;
+		}
+		return bit;
+	}
+
+	// skip any unread bits of current byte:
+	inline virtual void flushBits() override {
+		if(numBitsRead > 0) {
+			numBitsRead = 0;
+			current++;
+		}
+	};
+
+	inline bool isEmpty() const {
+		return current == end && numBytesLeft == 0;
+	}
+
+	// skip bits (e.g. those of the first byte that belong to a part of the stream that was read before)
+	inline void skipBits(const size_t numBits) {
+		for(size_t i = 0; i < numBits; i++)
+			readBit();
+	}
+
+	// number of bits read so far
+	inline size_t bitPosition() const {
+		return (numBytes - numBytesLeft - (end - current)) * 8 + numBitsRead;
+	}
+
+	inline bool outOfData() const {
+		return exhausted;
+	}
+
+private:
+	inline void fetch() {
+		if(numBytesLeft == 0) {
+			exhausted = true;
+			throw std::runtime_error("ChunkedBitstreamReader::readBit(): out of data");
+		}
+		const auto [data, len] = source.recvChunk(numBytesLeft);
+		current = data;
+		end = data + len;
+		numBytesLeft -= len;
+	}
 };
\ No newline at end of file
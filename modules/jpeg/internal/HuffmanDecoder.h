@@ -0,0 +1,144 @@
+#pragma once
+
+
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+#include "jpeg_constants.h"
+
+
+NAMESPACE_JPEG_BEGIN
+
+/**
+ * Bit reader over the entropy coded data of a scan: removes the stuffed zero bytes after 0xFF and stops in front of
+ * markers (delivering zero bits from there on, as the JPEG spec requires for a truncated segment).
+ * Bits are kept left aligned in a 64 bit buffer, so a refill covers several codes.
+*/
+class EntropyReader {
+private:
+	const uint8_t* pos;
+	const uint8_t* end;
+	uint64_t bits = 0;
+	int numBits = 0;
+	bool markerReached = false;
+
+public:
+	inline EntropyReader(const uint8_t* data, const uint8_t* end):
+		pos(data), end(end) { }
+
+	// at least 57 bits are buffered afterwards
+	inline void refill() {
+		while(numBits <= 56) {
+			uint8_t byte = 0;
+			if(!markerReached && pos < end) {
+				byte = *pos;
+				if(byte != 0xFF) {
+					pos++;
+				} else if(pos + 1 < end && pos[1] == 0x00) { // stuffed byte
+					pos += 2;
+				} else {
+					markerReached = true;
+					byte = 0;
+				}
+			}
+			bits |= static_cast<uint64_t>(byte) << (56 - numBits);
+			numBits += 8;
+		}
+	}
+
+	// the caller ensures that enough bits are buffered
+	inline uint32_t peek(const int n) const {
+		return static_cast<uint32_t>(bits >> (64 - n));
+	}
+
+	inline void skip(const int n) {
+		bits <<= n;
+		numBits -= n;
+	}
+
+	inline uint32_t get(const int n) {
+		if(n == 0) return 0;
+		const uint32_t value = peek(n);
+		skip(n);
+		return value;
+	}
+
+	inline int available() const {
+		return numBits;
+	}
+
+	// drops the remaining bits of the interval and the restart marker RSTn that follows it
+	inline void restart(const size_t n) {
+		bits = 0;
+		numBits = 0;
+		markerReached = false;
+		if(pos + 1 >= end || pos[0] != 0xFF || pos[1] != JpegConstants::RST0 + n % 8)
+			throw std::runtime_error("JPEG: missing restart marker");
+		pos += 2;
+	}
+
+	// position after the entropy coded data (the next marker)
+	inline const uint8_t* finish() const {
+		const uint8_t* p = pos;
+		while(p + 1 < end && !(p[0] == 0xFF && p[1] != 0x00 && !(p[1] >= JpegConstants::RST0 && p[1] <= JpegConstants::RST0 + 7)))
+			p++;
+		return p;
+	}
+};
+
+
+// canonical Huffman table of a DHT segment; codes of up to LOOKUP_BITS bits are decoded by a single table lookup
+class HuffmanDecoder {
+private:
+	static constexpr int LOOKUP_BITS = 9;
+
+	uint16_t lookup[1 << LOOKUP_BITS]; // length << 8 | symbol, 0 for longer codes
+	int32_t maxCode[17]; // largest code of each length, -1 if there is none
+	int32_t valueOffset[17]; // index of the symbol of a code of each length: code + valueOffset
+	uint8_t values[256];
+
+public:
+	// counts: number of codes of length 1 .. 16, followed by the symbols in order of their codes
+	inline void build(const uint8_t *const counts, const uint8_t *const symbols, const size_t numSymbols) {
+		if(numSymbols > 256)
+			throw std::runtime_error("JPEG: Huffman table with more than 256 symbols");
+		memcpy(values, symbols, numSymbols);
+		memset(lookup, 0, sizeof(lookup));
+
+		int32_t code = 0;
+		size_t index = 0;
+		for(int len = 1; len <= 16; len++) {
+			valueOffset[len] = static_cast<int32_t>(index) - code;
+			for(size_t i = 0; i < counts[len - 1]; i++, index++, code++) {
+				if(code >= (1 << len) || index >= numSymbols)
+					throw std::runtime_error("JPEG: invalid Huffman table");
+				if(len <= LOOKUP_BITS)
+					for(int32_t fill = 0; fill < (1 << (LOOKUP_BITS - len)); fill++)
+						lookup[code << (LOOKUP_BITS - len) | fill] = static_cast<uint16_t>(len << 8 | symbols[index]);
+			}
+			maxCode[len] = (counts[len - 1] > 0) ? code - 1 : -1;
+			code <<= 1;
+		}
+	}
+
+	// needs 16 buffered bits
+	inline uint8_t decode(EntropyReader& reader) const {
+		const uint16_t entry = lookup[reader.peek(LOOKUP_BITS)];
+		if(entry != 0) {
+			reader.skip(entry >> 8);
+			return entry & 0xFF;
+		}
+
+		int len = LOOKUP_BITS + 1;
+		while(len <= 16 && static_cast<int32_t>(reader.peek(len)) > maxCode[len])
+			len++;
+		if(len > 16)
+			throw std::runtime_error("JPEG: invalid Huffman code");
+		const int32_t code = reader.peek(len);
+		reader.skip(len);
+		return values[(code + valueOffset[len]) & 0xFF];
+	}
+};
+
+NAMESPACE_JPEG_END
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#include "jpeg_constants.h"
+#include "simd.h"
+
+
+NAMESPACE_JPEG_BEGIN
+
+// horizontal upsampling by replication (factor 2 is the common case: 4:2:0 and 4:2:2 chroma)
+inline void upsampleRow(const uint8_t *__restrict const src, uint8_t *__restrict const dst, const size_t factor, const size_t width) {
+	size_t x = 0;
+	if(factor == 2) {
+#ifdef JPEG_SSE2
+		for(; x + 32 <= width; x += 32) {
+			const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x / 2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_unpacklo_epi8(in, in));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 16), _mm_unpackhi_epi8(in, in));
+		}
+#endif
+		for(; x < width; x++)
+			dst[x] = src[x >> 1];
+	} else {
+		for(; x < width; x++)
+			dst[x] = src[x / factor];
+	}
+}
+
+inline void greyToBGRX(const uint8_t *__restrict const luma, uint32_t *__restrict const out, const size_t width) {
+	size_t x = 0;
+#ifdef JPEG_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for(; x + 16 <= width; x += 16) {
+		const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(luma + x));
+		const __m128i yy[2] = { _mm_unpacklo_epi8(y, y), _mm_unpackhi_epi8(y, y) };
+		const __m128i y0[2] = { _mm_unpacklo_epi8(y, zero), _mm_unpackhi_epi8(y, zero) };
+		for(size_t i = 0; i < 2; i++) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + x + i * 8), _mm_unpacklo_epi16(yy[i], y0[i]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + x + i * 8 + 4), _mm_unpackhi_epi16(yy[i], y0[i]));
+		}
+	}
+#endif
+	for(; x < width; x++)
+		out[x] = luma[x] * 0x010101u;
+}
+
+/**
+ * JFIF YCbCr to 32 bit BGRX with 16 bit fixed point factors, rounded like the IJG decoder.
+ * The SSE2 path splits each factor into an integer part and a 16 bit remainder (e.g. 1.402 * 65536 = 65536 + 26345)
+ * so the products fit pmaddwd; the result is identical to the portable loop.
+*/
+inline void ycbcrToBGRX(const uint8_t *__restrict const luma, const uint8_t *__restrict const cb, const uint8_t *__restrict const cr, uint32_t *__restrict const out, const size_t width) {
+	size_t x = 0;
+#ifdef JPEG_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16(128);
+	const __m128i two = _mm_set1_epi16(2); // (value, 2) * (factor, 16384): rounding constant 32768 inside pmaddwd
+	const __m128i rFactors = _mm_set_epi16(16384, 26345, 16384, 26345, 16384, 26345, 16384, 26345);
+	const __m128i bFactors = _mm_set_epi16(16384, -14942, 16384, -14942, 16384, -14942, 16384, -14942);
+	const __m128i gFactors = _mm_set_epi16(18734, -22554, 18734, -22554, 18734, -22554, 18734, -22554);
+	const __m128i gRound = _mm_set1_epi32(32768);
+
+	// ((pairs * factors) [+ round]) >> 16 for 8 lanes
+	const auto fraction = [](const __m128i lo, const __m128i hi, const __m128i factors, const __m128i round) {
+		return _mm_packs_epi32(
+			_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(lo, factors), round), 16),
+			_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(hi, factors), round), 16));
+	};
+
+	for(; x + 8 <= width; x += 8) {
+		const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(luma + x)), zero);
+		const __m128i u = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb + x)), zero), bias);
+		const __m128i v = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr + x)), zero), bias);
+
+		const __m128i rTerm = fraction(_mm_unpacklo_epi16(v, two), _mm_unpackhi_epi16(v, two), rFactors, zero);
+		const __m128i bTerm = fraction(_mm_unpacklo_epi16(u, two), _mm_unpackhi_epi16(u, two), bFactors, zero);
+		const __m128i gTerm = fraction(_mm_unpacklo_epi16(u, v), _mm_unpackhi_epi16(u, v), gFactors, gRound);
+
+		const __m128i r = _mm_add_epi16(_mm_add_epi16(y, v), rTerm); // 1.402 = 1 + 26345 / 65536
+		const __m128i g = _mm_add_epi16(_mm_sub_epi16(y, v), gTerm); // -0.71414 = -1 + 18734 / 65536
+		const __m128i b = _mm_add_epi16(_mm_add_epi16(y, _mm_add_epi16(u, u)), bTerm); // 1.772 = 2 - 14942 / 65536
+
+		const __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+		const __m128i r0 = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), zero);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_unpacklo_epi16(bg, r0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + x + 4), _mm_unpackhi_epi16(bg, r0));
+	}
+#endif
+	const auto clamp = [](const int32_t v) { return static_cast<uint32_t>(std::clamp(v, 0, 255)); };
+	for(; x < width; x++) {
+		const int32_t y = luma[x];
+		const int32_t u = cb[x] - 128;
+		const int32_t v = cr[x] - 128;
+		const uint32_t r = clamp(y + ((91881 * v + 32768) >> 16)); // 1.402
+		const uint32_t g = clamp(y + ((-22554 * u - 46802 * v + 32768) >> 16)); // 0.34414, 0.71414
+		const uint32_t b = clamp(y + ((116130 * u + 32768) >> 16)); // 1.772
+		out[x] = b | g << 8 | r << 16;
+	}
+}
+
+NAMESPACE_JPEG_END
\ No newline at end of file
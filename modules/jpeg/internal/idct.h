@@ -0,0 +1,219 @@
+#pragma once
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#include "jpeg_constants.h"
+#include "simd.h"
+
+
+NAMESPACE_JPEG_BEGIN
+
+/**
+ * Integer 8x8 inverse DCT, same arithmetic as the "islow" IDCT of the IJG reference decoder (13 bit fixed point
+ * constants, 2 extra bits of precision between the passes), so the output matches it exactly.
+ * Each pass transforms all eight columns at once with identical operations per column (lane), and the passes are
+ * separated by a transpose. With SSE2 a lane is a 16 bit element and the products are formed by pmaddwd on
+ * interleaved coefficient pairs; the portable loops are left to the compiler's vectorizer.
+*/
+namespace IDCT {
+	static constexpr int CONST_BITS = 13;
+	static constexpr int PASS1_BITS = 2;
+	static constexpr int PASS1_SHIFT = CONST_BITS - PASS1_BITS;
+	static constexpr int PASS2_SHIFT = CONST_BITS + PASS1_BITS + 3;
+
+	static constexpr int32_t FIX_0_298631336 = 2446;
+	static constexpr int32_t FIX_0_390180644 = 3196;
+	static constexpr int32_t FIX_0_541196100 = 4433;
+	static constexpr int32_t FIX_0_765366865 = 6270;
+	static constexpr int32_t FIX_0_899976223 = 7373;
+	static constexpr int32_t FIX_1_175875602 = 9633;
+	static constexpr int32_t FIX_1_501321110 = 12299;
+	static constexpr int32_t FIX_1_847759065 = 15137;
+	static constexpr int32_t FIX_1_961570560 = 16069;
+	static constexpr int32_t FIX_2_053119869 = 16819;
+	static constexpr int32_t FIX_2_562915447 = 20995;
+	static constexpr int32_t FIX_3_072711026 = 25172;
+
+	// 1-D IDCT of 8 lanes: in[k * 8 + lane] is coefficient k of a lane, out[k * 8 + lane] the k-th sample (descaled by SHIFT);
+	// in and out must not overlap (otherwise the compiler needs a runtime check before it vectorizes)
+	template<int SHIFT, typename In>
+	inline void transformLanes(const In *__restrict const in, int32_t *__restrict const out) {
+		constexpr int32_t ROUND = 1 << (SHIFT - 1);
+
+		for(size_t l = 0; l < 8; l++) {
+			// even part:
+			const int32_t z1 = (in[2 * 8 + l] + in[6 * 8 + l]) * FIX_0_541196100;
+			const int32_t tmp2 = z1 - in[6 * 8 + l] * FIX_1_847759065;
+			const int32_t tmp3 = z1 + in[2 * 8 + l] * FIX_0_765366865;
+			const int32_t tmp0 = (in[0 * 8 + l] + in[4 * 8 + l]) * (1 << CONST_BITS);
+			const int32_t tmp1 = (in[0 * 8 + l] - in[4 * 8 + l]) * (1 << CONST_BITS);
+
+			const int32_t tmp10 = tmp0 + tmp3;
+			const int32_t tmp13 = tmp0 - tmp3;
+			const int32_t tmp11 = tmp1 + tmp2;
+			const int32_t tmp12 = tmp1 - tmp2;
+
+			// odd part:
+			const int32_t o0 = in[7 * 8 + l];
+			const int32_t o1 = in[5 * 8 + l];
+			const int32_t o2 = in[3 * 8 + l];
+			const int32_t o3 = in[1 * 8 + l];
+
+			const int32_t z5 = (o0 + o2 + o1 + o3) * FIX_1_175875602;
+			const int32_t y1 = (o0 + o3) * -FIX_0_899976223;
+			const int32_t y2 = (o1 + o2) * -FIX_2_562915447;
+			const int32_t y3 = (o0 + o2) * -FIX_1_961570560 + z5;
+			const int32_t y4 = (o1 + o3) * -FIX_0_390180644 + z5;
+
+			const int32_t p0 = o0 * FIX_0_298631336 + y1 + y3;
+			const int32_t p1 = o1 * FIX_2_053119869 + y2 + y4;
+			const int32_t p2 = o2 * FIX_3_072711026 + y2 + y3;
+			const int32_t p3 = o3 * FIX_1_501321110 + y1 + y4;
+
+			out[0 * 8 + l] = (tmp10 + p3 + ROUND) >> SHIFT;
+			out[7 * 8 + l] = (tmp10 - p3 + ROUND) >> SHIFT;
+			out[1 * 8 + l] = (tmp11 + p2 + ROUND) >> SHIFT;
+			out[6 * 8 + l] = (tmp11 - p2 + ROUND) >> SHIFT;
+			out[2 * 8 + l] = (tmp12 + p1 + ROUND) >> SHIFT;
+			out[5 * 8 + l] = (tmp12 - p1 + ROUND) >> SHIFT;
+			out[3 * 8 + l] = (tmp13 + p0 + ROUND) >> SHIFT;
+			out[4 * 8 + l] = (tmp13 - p0 + ROUND) >> SHIFT;
+		}
+	}
+
+	inline void transpose(const int32_t *const in, int32_t *const out) {
+		for(size_t y = 0; y < 8; y++)
+			for(size_t x = 0; x < 8; x++)
+				out[x * 8 + y] = in[y * 8 + x];
+	}
+
+#ifdef JPEG_SSE2
+	// pmaddwd factors: a * first + b * second of each interleaved pair
+	inline __m128i pair(const int32_t a, const int32_t b) {
+		return _mm_set_epi16(int16_t(b), int16_t(a), int16_t(b), int16_t(a), int16_t(b), int16_t(a), int16_t(b), int16_t(a));
+	}
+
+	// transformLanes() on the eight 16 bit lanes of v[k] (= coefficient k), bias is added before the descale;
+	// the products of the reference are regrouped into two pmaddwd per term, which is exact in integer arithmetic
+	template<int SHIFT>
+	inline void transformLanesSSE2(__m128i (&v)[8], const int32_t bias) {
+		const __m128i round = _mm_set1_epi32(bias);
+		__m128i out[2][8];
+
+		for(size_t half = 0; half < 2; half++) {
+			const auto interleave = [half](const __m128i a, const __m128i b) { return half ? _mm_unpackhi_epi16(a, b) : _mm_unpacklo_epi16(a, b); };
+			const __m128i e04 = interleave(v[0], v[4]);
+			const __m128i e26 = interleave(v[2], v[6]);
+			const __m128i o75 = interleave(v[7], v[5]);
+			const __m128i o31 = interleave(v[3], v[1]);
+
+			// even part:
+			const __m128i tmp0 = _mm_madd_epi16(e04, pair(1 << CONST_BITS, 1 << CONST_BITS));
+			const __m128i tmp1 = _mm_madd_epi16(e04, pair(1 << CONST_BITS, -(1 << CONST_BITS)));
+			const __m128i tmp2 = _mm_madd_epi16(e26, pair(FIX_0_541196100, FIX_0_541196100 - FIX_1_847759065));
+			const __m128i tmp3 = _mm_madd_epi16(e26, pair(FIX_0_541196100 + FIX_0_765366865, FIX_0_541196100));
+
+			const __m128i tmp10 = _mm_add_epi32(_mm_add_epi32(tmp0, tmp3), round);
+			const __m128i tmp13 = _mm_add_epi32(_mm_sub_epi32(tmp0, tmp3), round);
+			const __m128i tmp11 = _mm_add_epi32(_mm_add_epi32(tmp1, tmp2), round);
+			const __m128i tmp12 = _mm_add_epi32(_mm_sub_epi32(tmp1, tmp2), round);
+
+			// odd part, pairs (o0, o1) and (o2, o3):
+			const __m128i p0 = _mm_add_epi32(
+				_mm_madd_epi16(o75, pair(FIX_0_298631336 - FIX_0_899976223 - FIX_1_961570560 + FIX_1_175875602, FIX_1_175875602)),
+				_mm_madd_epi16(o31, pair(FIX_1_175875602 - FIX_1_961570560, FIX_1_175875602 - FIX_0_899976223)));
+			const __m128i p1 = _mm_add_epi32(
+				_mm_madd_epi16(o75, pair(FIX_1_175875602, FIX_2_053119869 - FIX_2_562915447 - FIX_0_390180644 + FIX_1_175875602)),
+				_mm_madd_epi16(o31, pair(FIX_1_175875602 - FIX_2_562915447, FIX_1_175875602 - FIX_0_390180644)));
+			const __m128i p2 = _mm_add_epi32(
+				_mm_madd_epi16(o75, pair(FIX_1_175875602 - FIX_1_961570560, FIX_1_175875602 - FIX_2_562915447)),
+				_mm_madd_epi16(o31, pair(FIX_3_072711026 - FIX_2_562915447 - FIX_1_961570560 + FIX_1_175875602, FIX_1_175875602)));
+			const __m128i p3 = _mm_add_epi32(
+				_mm_madd_epi16(o75, pair(FIX_1_175875602 - FIX_0_899976223, FIX_1_175875602 - FIX_0_390180644)),
+				_mm_madd_epi16(o31, pair(FIX_1_175875602, FIX_1_501321110 - FIX_0_899976223 - FIX_0_390180644 + FIX_1_175875602)));
+
+			out[half][0] = _mm_srai_epi32(_mm_add_epi32(tmp10, p3), SHIFT);
+			out[half][7] = _mm_srai_epi32(_mm_sub_epi32(tmp10, p3), SHIFT);
+			out[half][1] = _mm_srai_epi32(_mm_add_epi32(tmp11, p2), SHIFT);
+			out[half][6] = _mm_srai_epi32(_mm_sub_epi32(tmp11, p2), SHIFT);
+			out[half][2] = _mm_srai_epi32(_mm_add_epi32(tmp12, p1), SHIFT);
+			out[half][5] = _mm_srai_epi32(_mm_sub_epi32(tmp12, p1), SHIFT);
+			out[half][3] = _mm_srai_epi32(_mm_add_epi32(tmp13, p0), SHIFT);
+			out[half][4] = _mm_srai_epi32(_mm_sub_epi32(tmp13, p0), SHIFT);
+		}
+
+		for(size_t k = 0; k < 8; k++)
+			v[k] = _mm_packs_epi32(out[0][k], out[1][k]);
+	}
+
+	inline void transposeSSE2(__m128i (&v)[8]) {
+		const __m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+		const __m128i a1 = _mm_unpackhi_epi16(v[0], v[1]);
+		const __m128i a2 = _mm_unpacklo_epi16(v[2], v[3]);
+		const __m128i a3 = _mm_unpackhi_epi16(v[2], v[3]);
+		const __m128i a4 = _mm_unpacklo_epi16(v[4], v[5]);
+		const __m128i a5 = _mm_unpackhi_epi16(v[4], v[5]);
+		const __m128i a6 = _mm_unpacklo_epi16(v[6], v[7]);
+		const __m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+
+		const __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+		const __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+		const __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+		const __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+		const __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+		const __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+		const __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+		const __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+		v[0] = _mm_unpacklo_epi64(b0, b4);
+		v[1] = _mm_unpackhi_epi64(b0, b4);
+		v[2] = _mm_unpacklo_epi64(b1, b5);
+		v[3] = _mm_unpackhi_epi64(b1, b5);
+		v[4] = _mm_unpacklo_epi64(b2, b6);
+		v[5] = _mm_unpackhi_epi64(b2, b6);
+		v[6] = _mm_unpacklo_epi64(b3, b7);
+		v[7] = _mm_unpackhi_epi64(b3, b7);
+	}
+#endif
+};
+
+// coef: dequantized coefficients in natural order (16 byte aligned); writes 8x8 samples (level shifted, clamped) with a stride of stride bytes
+inline void idct8x8(const int16_t *const coef, uint8_t *const dst, const size_t stride) {
+#ifdef JPEG_SSE2
+	__m128i v[8];
+	for(size_t k = 0; k < 8; k++)
+		v[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(coef + k * 8));
+
+	IDCT::transformLanesSSE2<IDCT::PASS1_SHIFT>(v, 1 << (IDCT::PASS1_SHIFT - 1)); // v[y]: row y
+	IDCT::transposeSSE2(v); // v[x]: column x
+	IDCT::transformLanesSSE2<IDCT::PASS2_SHIFT>(v, (1 << (IDCT::PASS2_SHIFT - 1)) + (128 << IDCT::PASS2_SHIFT)); // level shifted
+	IDCT::transposeSSE2(v);
+
+	for(size_t y = 0; y < 8; y++) // unsigned saturation is the clamp
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + y * stride), _mm_packus_epi16(v[y], v[y]));
+#else
+	alignas(32) int32_t columns[64];
+	alignas(32) int32_t rows[64];
+
+	IDCT::transformLanes<IDCT::PASS1_SHIFT>(coef, columns); // columns[y * 8 + x]
+	IDCT::transpose(columns, rows); // rows[x * 8 + y]
+	IDCT::transformLanes<IDCT::PASS2_SHIFT>(rows, columns); // columns[x * 8 + y]
+	IDCT::transpose(columns, rows); // rows[y * 8 + x]
+
+	for(size_t y = 0; y < 8; y++)
+		for(size_t x = 0; x < 8; x++)
+			dst[y * stride + x] = static_cast<uint8_t>(std::clamp(rows[y * 8 + x] + 128, 0, 255));
+#endif
+}
+
+// block without AC coefficients: constant
+inline void idct8x8DC(const int32_t dc, uint8_t *const dst, const size_t stride) {
+	const uint8_t value = static_cast<uint8_t>(std::clamp(((dc + 4) >> 3) + 128, 0, 255));
+	for(size_t y = 0; y < 8; y++)
+		std::fill_n(dst + y * stride, 8, value);
+}
+
+NAMESPACE_JPEG_END
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+
+#include <cstdint>
+
+
+#define NAMESPACE_JPEG_BEGIN namespace jpeg {
+#define NAMESPACE_JPEG_END };
+
+
+NAMESPACE_JPEG_BEGIN
+
+namespace JpegConstants {
+	// markers (second byte after 0xFF):
+	static constexpr uint8_t SOF0 = 0xC0; // baseline DCT
+	static constexpr uint8_t SOF1 = 0xC1; // extended sequential DCT (Huffman)
+	static constexpr uint8_t DHT  = 0xC4;
+	static constexpr uint8_t DAC  = 0xCC; // arithmetic coding conditioning
+	static constexpr uint8_t RST0 = 0xD0; // .. RST7
+	static constexpr uint8_t SOI  = 0xD8;
+	static constexpr uint8_t EOI  = 0xD9;
+	static constexpr uint8_t SOS  = 0xDA;
+	static constexpr uint8_t DQT  = 0xDB;
+	static constexpr uint8_t DNL  = 0xDC;
+	static constexpr uint8_t DRI  = 0xDD;
+
+	// natural (row major) position of the i-th coefficient in zigzag order
+	static constexpr uint8_t ZIGZAG[64] {
+		 0,  1,  8, 16,  9,  2,  3, 10,
+		17, 24, 32, 25, 18, 11,  4,  5,
+		12, 19, 26, 33, 40, 48, 41, 34,
+		27, 20, 13,  6,  7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36,
+		29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46,
+		53, 60, 61, 54, 47, 55, 62, 63,
+	};
+};
+
+NAMESPACE_JPEG_END
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+
+
+// SSE2 code paths (always available on x86-64); other targets use the portable loops, which are written so that
+// compilers can vectorize them. Defining JPEG_NO_SIMD forces the portable code (for testing).
+#if !defined(JPEG_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define JPEG_SSE2
+	#include <emmintrin.h>
+#endif
\ No newline at end of file
@@ -0,0 +1,334 @@
+#pragma once
+
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "internal/jpeg_constants.h"
+#include "internal/HuffmanDecoder.h"
+#include "internal/idct.h"
+#include "internal/color.h"
+
+
+// JPEG (ITU T.81), baseline subset
+
+
+NAMESPACE_JPEG_BEGIN
+
+/**
+ * Baseline JPEG decoder (sequential DCT, Huffman coding, 8 bit samples) writing 32 bit BGRX pixels straight into
+ * a caller owned image, e.g. a rect of the VNC framebuffer.
+ * Greyscale and YCbCr images with integer chroma subsampling factors (4:4:4, 4:2:2, 4:2:0, ...) and restart intervals
+ * are supported; progressive, arithmetic coded, lossless and 12 bit images are rejected.
+ * Chroma is upsampled by replication. The image is decoded one row of MCUs at a time, so the working set stays
+ * in cache; the decoder keeps its buffers between images.
+*/
+class Decoder {
+private:
+	struct Component {
+		uint8_t id;
+		size_t h, v; // sampling factors
+		uint8_t quantTable;
+		uint8_t dcTable;
+		uint8_t acTable;
+		int32_t dcPrediction;
+		std::vector<uint8_t> samples; // one row of MCUs
+		size_t stride;
+	};
+
+	uint16_t quantTables[4][64] {}; // in zigzag order
+	HuffmanDecoder dcTables[4];
+	HuffmanDecoder acTables[4];
+
+	Component components[3];
+	size_t numComponents = 0;
+	size_t width = 0;
+	size_t height = 0;
+	size_t hMax = 1;
+	size_t vMax = 1;
+	size_t restartInterval = 0;
+
+	std::vector<uint8_t> upsampled[3]; // one row of each component at full resolution
+
+public:
+	// decodes a complete JPEG image of width x height pixels to dst (row stride: stride pixels)
+	inline void decode(const uint8_t *const data, const size_t len, uint32_t *const dst, const size_t stride, const size_t dstWidth, const size_t dstHeight) {
+		const uint8_t* p = data;
+		const uint8_t *const end = data + len;
+		if(len < 2 || p[0] != 0xFF || p[1] != JpegConstants::SOI)
+			throw std::runtime_error("JPEG: missing SOI marker");
+		p += 2;
+
+		numComponents = 0;
+		restartInterval = 0;
+		bool scanDecoded = false;
+		for(;;) {
+			if(p + 2 > end) {
+				if(scanDecoded) return; // tolerate a missing EOI
+				throw std::runtime_error("JPEG: unexpected end of data");
+			}
+			if(p[0] != 0xFF)
+				throw std::runtime_error("JPEG: marker expected");
+			const uint8_t marker = p[1];
+			if(marker == 0xFF) { // fill byte
+				p++;
+				continue;
+			}
+			p += 2;
+			if(marker == JpegConstants::EOI) {
+				if(!scanDecoded) throw std::runtime_error("JPEG: image without scan");
+				return;
+			}
+
+			// segment with length:
+			if(p + 2 > end)
+				throw std::runtime_error("JPEG: unexpected end of data");
+			const size_t segmentLength = p[0] << 8 | p[1];
+			if(segmentLength < 2 || p + segmentLength > end)
+				throw std::runtime_error("JPEG: invalid segment length");
+			const uint8_t *const segment = p + 2;
+			const uint8_t *const segmentEnd = p + segmentLength;
+			p = segmentEnd;
+
+			switch(marker) {
+				case JpegConstants::SOF0:
+				case JpegConstants::SOF1:
+					readFrameHeader(segment, segmentEnd, dstWidth, dstHeight);
+					break;
+				case JpegConstants::DHT:
+					readHuffmanTables(segment, segmentEnd);
+					break;
+				case JpegConstants::DQT:
+					readQuantizationTables(segment, segmentEnd);
+					break;
+				case JpegConstants::DRI:
+					if(segmentEnd - segment < 2) throw std::runtime_error("JPEG: invalid DRI segment");
+					restartInterval = segment[0] << 8 | segment[1];
+					break;
+				case JpegConstants::SOS:
+					if(scanDecoded) throw std::runtime_error("JPEG: images with several scans are not supported");
+					readScanHeader(segment, segmentEnd);
+					p = decodeScan(p, end, dst, stride);
+					scanDecoded = true;
+					break;
+				case JpegConstants::DNL:
+					throw std::runtime_error("JPEG: DNL marker is not supported");
+				default:
+					if(marker >= 0xC0 && marker <= 0xCF && marker != JpegConstants::DAC) // other SOFn: progressive, lossless, arithmetic
+						throw std::runtime_error("JPEG: unsupported frame type " + std::to_string(marker - 0xC0) + " (only baseline is supported)");
+					break; // APPn, COM, DAC
+			}
+		}
+	}
+
+private:
+	inline void readFrameHeader(const uint8_t* p, const uint8_t *const end, const size_t dstWidth, const size_t dstHeight) {
+		if(end - p < 6)
+			throw std::runtime_error("JPEG: invalid frame header");
+		if(p[0] != 8)
+			throw std::runtime_error("JPEG: unsupported sample precision " + std::to_string(p[0]));
+		height = p[1] << 8 | p[2];
+		width = p[3] << 8 | p[4];
+		numComponents = p[5];
+		p += 6;
+
+		if(height == 0)
+			throw std::runtime_error("JPEG: DNL marker is not supported");
+		if(width != dstWidth || height != dstHeight)
+			throw std::runtime_error("JPEG: image of " + std::to_string(width) + "x" + std::to_string(height) + " pixels, expected " + std::to_string(dstWidth) + "x" + std::to_string(dstHeight));
+		if(numComponents != 1 && numComponents != 3)
+			throw std::runtime_error("JPEG: unsupported number of components " + std::to_string(numComponents));
+		if(end - p < static_cast<ptrdiff_t>(numComponents * 3))
+			throw std::runtime_error("JPEG: invalid frame header");
+
+		hMax = vMax = 1;
+		for(size_t i = 0; i < numComponents; i++, p += 3) {
+			Component& component = components[i];
+			component.id = p[0];
+			component.h = p[1] >> 4;
+			component.v = p[1] & 0x0F;
+			component.quantTable = p[2] & 0x03;
+			if(component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4)
+				throw std::runtime_error("JPEG: invalid sampling factors");
+			if(numComponents == 1) // a single component is not interleaved: one block per MCU
+				component.h = component.v = 1;
+			hMax = std::max(hMax, component.h);
+			vMax = std::max(vMax, component.v);
+		}
+		for(size_t i = 0; i < numComponents; i++) {
+			if(hMax % components[i].h != 0 || vMax % components[i].v != 0)
+				throw std::runtime_error("JPEG: unsupported (non integer) subsampling ratio");
+			upsampled[i].resize(width);
+		}
+	}
+
+	inline void readHuffmanTables(const uint8_t* p, const uint8_t *const end) {
+		while(p < end) {
+			if(end - p < 17)
+				throw std::runtime_error("JPEG: invalid DHT segment");
+			const uint8_t tableClass = p[0] >> 4;
+			const uint8_t id = p[0] & 0x0F;
+			const uint8_t *const counts = p + 1;
+			size_t numSymbols = 0;
+			for(size_t i = 0; i < 16; i++)
+				numSymbols += counts[i];
+			p += 17;
+			if(tableClass > 1 || id > 3 || end - p < static_cast<ptrdiff_t>(numSymbols))
+				throw std::runtime_error("JPEG: invalid DHT segment");
+
+			(tableClass == 0 ? dcTables : acTables)[id].build(counts, p, numSymbols);
+			p += numSymbols;
+		}
+	}
+
+	inline void readQuantizationTables(const uint8_t* p, const uint8_t *const end) {
+		while(p < end) {
+			const uint8_t precision = p[0] >> 4; // 0: 8 bit, 1: 16 bit values
+			const uint8_t id = p[0] & 0x0F;
+			p++;
+			if(precision > 1 || id > 3 || end - p < 64 * (precision + 1))
+				throw std::runtime_error("JPEG: invalid DQT segment");
+
+			for(size_t i = 0; i < 64; i++, p += precision + 1)
+				quantTables[id][i] = precision ? (p[0] << 8 | p[1]) : p[0];
+		}
+	}
+
+	inline void readScanHeader(const uint8_t* p, const uint8_t *const end) {
+		if(numComponents == 0)
+			throw std::runtime_error("JPEG: scan before frame header");
+		if(end - p < 1 || p[0] != numComponents || end - p < static_cast<ptrdiff_t>(1 + p[0] * 2 + 3))
+			throw std::runtime_error("JPEG: scans have to contain all components (single scan images only)");
+
+		for(size_t i = 0; i < numComponents; i++) {
+			const uint8_t id = p[1 + i * 2];
+			const uint8_t tables = p[2 + i * 2];
+			Component *const component = std::find_if(components, components + numComponents, [&](const Component& c) { return c.id == id; });
+			if(component == components + numComponents)
+				throw std::runtime_error("JPEG: scan references an unknown component");
+			component->dcTable = (tables >> 4) & 0x03;
+			component->acTable = tables & 0x03;
+		}
+	}
+
+	// decodes the entropy coded data of the scan starting at p; returns the position of the marker following it
+	inline const uint8_t* decodeScan(const uint8_t *const p, const uint8_t *const end, uint32_t *const dst, const size_t stride) {
+		const size_t mcuWidth = 8 * hMax;
+		const size_t mcuHeight = 8 * vMax;
+		const size_t mcusX = (width + mcuWidth - 1) / mcuWidth;
+		const size_t mcusY = (height + mcuHeight - 1) / mcuHeight;
+
+		for(size_t i = 0; i < numComponents; i++) {
+			Component& component = components[i];
+			component.stride = mcusX * component.h * 8;
+			component.samples.resize(component.stride * component.v * 8);
+			component.dcPrediction = 0;
+		}
+
+		EntropyReader reader(p, end);
+		size_t mcusToRestart = restartInterval;
+		size_t restartIndex = 0;
+		alignas(16) int16_t coef[64];
+
+		for(size_t mcuY = 0; mcuY < mcusY; mcuY++) {
+			for(size_t mcuX = 0; mcuX < mcusX; mcuX++) {
+				if(restartInterval > 0) {
+					if(mcusToRestart == 0) {
+						reader.restart(restartIndex++);
+						for(size_t i = 0; i < numComponents; i++)
+							components[i].dcPrediction = 0;
+						mcusToRestart = restartInterval;
+					}
+					mcusToRestart--;
+				}
+
+				for(size_t i = 0; i < numComponents; i++) {
+					Component& component = components[i];
+					for(size_t v = 0; v < component.v; v++)
+						for(size_t h = 0; h < component.h; h++)
+							decodeBlock(reader, component, coef, component.samples.data() + v * 8 * component.stride + (mcuX * component.h + h) * 8);
+				}
+			}
+
+			const size_t y0 = mcuY * mcuHeight;
+			for(size_t y = y0; y < std::min(y0 + mcuHeight, height); y++)
+				writeRow(y - y0, dst + y * stride);
+		}
+
+		return reader.finish();
+	}
+
+	// sign extension of a received value of size bits (F.2.2.1)
+	static inline int32_t extend(const uint32_t value, const int size) {
+		return (value < (1u << (size - 1))) ? static_cast<int32_t>(value) - (1 << size) + 1 : static_cast<int32_t>(value);
+	}
+
+	inline void decodeBlock(EntropyReader& reader, Component& component, int16_t *const coef, uint8_t *const out) {
+		const uint16_t *const quant = quantTables[component.quantTable];
+		const HuffmanDecoder& acTable = acTables[component.acTable];
+		std::fill_n(coef, 64, 0);
+
+		// DC: difference to the previous block of the component
+		if(reader.available() < 32) reader.refill();
+		const int dcSize = dcTables[component.dcTable].decode(reader);
+		if(dcSize > 16)
+			throw std::runtime_error("JPEG: invalid DC coefficient size");
+		if(dcSize > 0)
+			component.dcPrediction += extend(reader.get(dcSize), dcSize);
+		coef[0] = static_cast<int16_t>(component.dcPrediction * quant[0]);
+
+		// AC: run length of zeros and size of the next coefficient, in zigzag order
+		bool hasAC = false;
+		for(size_t k = 1; k < 64; ) {
+			if(reader.available() < 32) reader.refill();
+			const uint8_t symbol = acTable.decode(reader);
+			const size_t run = symbol >> 4;
+			const int size = symbol & 0x0F;
+
+			if(size == 0) {
+				if(run != 15) break; // end of block
+				k += 16;
+				continue;
+			}
+
+			k += run;
+			if(k > 63)
+				throw std::runtime_error("JPEG: coefficient index out of range");
+			coef[JpegConstants::ZIGZAG[k]] = static_cast<int16_t>(extend(reader.get(size), size) * quant[k]);
+			hasAC = true;
+			k++;
+		}
+
+		if(hasAC)
+			idct8x8(coef, out, component.stride);
+		else
+			idct8x8DC(coef[0], out, component.stride);
+	}
+
+	// row y of the current row of MCUs, horizontally upsampled to full width if necessary
+	inline const uint8_t* componentRow(const size_t index, const size_t y) {
+		const Component& component = components[index];
+		const uint8_t *const src = component.samples.data() + y * component.v / vMax * component.stride;
+		const size_t factor = hMax / component.h;
+		if(factor == 1)
+			return src;
+
+		uint8_t *const row = upsampled[index].data();
+		upsampleRow(src, row, factor, width);
+		return row;
+	}
+
+	inline void writeRow(const size_t y, uint32_t *const out) {
+		const uint8_t *const luma = componentRow(0, y);
+		if(numComponents == 1)
+			greyToBGRX(luma, out, width);
+		else
+			ycbcrToBGRX(luma, componentRow(1, y), componentRow(2, y), out, width);
+	}
+};
+
+NAMESPACE_JPEG_END
\ No newline at end of file
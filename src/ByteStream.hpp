@@ -0,0 +1,121 @@
+#pragma once
+
+
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <string>
+#include <vector>
+
+
+/**
+ * Typed send / receive helpers shared by all byte-stream transports (CRTP).
+ * Derived has to provide:
+ *  - void send(const void* buffer, int size) const
+ *  - int recv(void* buffer, int size) const  (blocks until at least one byte arrived)
+ * and may provide flush() if it holds back sent data.
+ * Multi-byte integers are sent / received in network byte order.
+*/
+template<typename Derived>
+class ByteStream {
+public:
+	using Chunk = std::pair<const uint8_t*, size_t>;
+
+private:
+	static constexpr size_t CHUNK_BUFFER_SIZE = 64 * 1024;
+
+	mutable std::vector<uint8_t> chunkBuffer; // backing storage of recvChunk() for transports without own receive buffers
+
+public:
+	// -- sending:
+	template<typename T>
+	inline void sendPrimitive(const std::remove_cv_t<T>& val) const {
+		derived().send(&val, sizeof(T));
+	}
+
+	inline void sendU8(const uint8_t val) const {
+		sendPrimitive<uint8_t>(val);
+	}
+
+	inline void sendU16(const uint16_t val) const {
+		const uint8_t bytes[2] { static_cast<uint8_t>(val >> 8), static_cast<uint8_t>(val) };
+		derived().send(bytes, sizeof(bytes));
+	}
+
+	inline void sendU32(const uint32_t val) const {
+		const uint8_t bytes[4] { static_cast<uint8_t>(val >> 24), static_cast<uint8_t>(val >> 16), static_cast<uint8_t>(val >> 8), static_cast<uint8_t>(val) };
+		derived().send(bytes, sizeof(bytes));
+	}
+
+	inline void sendS32(const int32_t val) const {
+		sendU32(static_cast<uint32_t>(val));
+	}
+
+	// hands everything sent so far to the network; called after each complete message (most transports send right away)
+	inline void flush() const { }
+
+
+	// -- receiving:
+	inline void recvExactly(void *const buffer, const size_t buffer_size) const {
+		size_t len_received = 0;
+		do {
+			len_received += derived().recv(reinterpret_cast<char*>(buffer) + len_received, buffer_size - len_received);
+		} while(len_received < buffer_size);
+	}
+
+	/**
+	 * Receives between 1 and maxLen bytes and returns a view of them.
+	 * The view stays valid until the next receive call on this transport.
+	*/
+	inline Chunk recvChunk(const size_t maxLen) const {
+		if(chunkBuffer.size() < CHUNK_BUFFER_SIZE)
+			chunkBuffer.resize(CHUNK_BUFFER_SIZE);
+
+		const int len = derived().recv(chunkBuffer.data(), std::min(maxLen, chunkBuffer.size()));
+		return Chunk(chunkBuffer.data(), len);
+	}
+
+	inline std::string recvString(const size_t len) const {
+		std::vector<char> text(len);
+		recvExactly(text.data(), len);
+
+		std::string str;
+		str.append(text.data(), len);
+		return str;
+	}
+
+	template<typename T>
+	inline std::remove_cv_t<T> recvPrimitive() const {
+		std::remove_cv_t<T> res;
+
+		recvExactly(&res, sizeof(T));
+
+		return res;
+	}
+
+	inline uint8_t recvU8() const {
+		return recvPrimitive<uint8_t>();
+	}
+
+	inline uint16_t recvU16() const {
+		uint8_t bytes[2];
+		recvExactly(bytes, sizeof(bytes));
+		return bytes[0] << 8 | bytes[1];
+	}
+
+	inline uint32_t recvU32() const {
+		uint8_t bytes[4];
+		recvExactly(bytes, sizeof(bytes));
+		return static_cast<uint32_t>(bytes[0]) << 24 | bytes[1] << 16 | bytes[2] << 8 | bytes[3];
+	}
+
+	inline int32_t recvS32() const {
+		return static_cast<int32_t>(recvU32());
+	}
+
+private:
+	inline const Derived& derived() const {
+		return static_cast<const Derived&>(*this);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+
+// cursor image of the Cursor pseudo-encoding, ready to be drawn over the framebuffer (or a scaled view of it)
+struct CursorShape {
+	uint16_t width = 0;
+	uint16_t height = 0;
+	uint16_t hotX = 0; // pixel at the pointer position
+	uint16_t hotY = 0;
+	std::vector<uint32_t> pixels; // blue | green << 8 | red << 16, 0xFF << 24 where the mask is set, 0 elsewhere
+
+	/**
+	 * Draws the shape into a 32 bit buffer with its hotspot at (pointerX, pointerY), clipped to the buffer.
+	 * Masked-out pixels keep the destination (select by the sign bit of the alpha byte, without branches).
+	*/
+	inline void composite(uint32_t *const dst, const size_t dstWidth, const size_t dstHeight, const ptrdiff_t pointerX, const ptrdiff_t pointerY) const {
+		const ptrdiff_t left = pointerX - hotX;
+		const ptrdiff_t top = pointerY - hotY;
+		const ptrdiff_t x0 = std::max<ptrdiff_t>(0, -left);
+		const ptrdiff_t y0 = std::max<ptrdiff_t>(0, -top);
+		const ptrdiff_t x1 = std::min<ptrdiff_t>(width, static_cast<ptrdiff_t>(dstWidth) - left);
+		const ptrdiff_t y1 = std::min<ptrdiff_t>(height, static_cast<ptrdiff_t>(dstHeight) - top);
+
+		for(ptrdiff_t y = y0; y < y1; y++) {
+			const uint32_t *const src = pixels.data() + y * width + x0;
+			uint32_t *const row = dst + (top + y) * dstWidth + (left + x0);
+			for(ptrdiff_t x = 0; x < x1 - x0; x++) {
+				const uint32_t opaque = static_cast<uint32_t>(static_cast<int32_t>(src[x]) >> 31);
+				row[x] = (src[x] & opaque & 0x00FFFFFF) | (row[x] & ~opaque);
+			}
+		}
+	}
+};
+
+
+/**
+ * Shapes by hash of their wire data (size, hotspot, pixels and mask). Applications switch between a handful of cursors,
+ * and servers resend the whole shape on every switch; a hit only costs hashing and comparing it.
+ * The wire data is kept to rule out hash collisions. Least recently used shapes are dropped beyond MAX_ENTRIES.
+*/
+class CursorCache {
+public:
+	static constexpr size_t MAX_ENTRIES = 32;
+
+private:
+	struct Entry {
+		std::vector<uint8_t> wireData;
+		std::shared_ptr<const CursorShape> shape;
+		size_t lastUse;
+	};
+
+	std::unordered_multimap<uint64_t, Entry> entries;
+	size_t useCounter = 0;
+	size_t hits = 0;
+
+	static inline uint64_t mix(uint64_t h, const uint64_t word) {
+		h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+		return h ^ (h >> 29);
+	}
+
+public:
+	// 64 bit hash of the wire data, 8 bytes per step
+	static inline uint64_t hash(const uint8_t* data, size_t len, const uint16_t width, const uint16_t height, const uint16_t hotX, const uint16_t hotY) {
+		uint64_t h = mix(len, uint64_t(width) | uint64_t(height) << 16 | uint64_t(hotX) << 32 | uint64_t(hotY) << 48);
+		for(; len >= 8; data += 8, len -= 8) {
+			uint64_t word;
+			memcpy(&word, data, 8);
+			h = mix(h, word);
+		}
+		uint64_t tail = 0;
+		memcpy(&tail, data, len);
+		return mix(h, tail);
+	}
+
+	// shape for this wire data: cached, or made by decode() (returning a CursorShape) and cached
+	template<typename Decode>
+	inline std::shared_ptr<const CursorShape> get(const uint8_t *const data, const size_t len, const uint16_t width, const uint16_t height, const uint16_t hotX, const uint16_t hotY, Decode&& decode) {
+		const uint64_t key = hash(data, len, width, height, hotX, hotY);
+		const auto [begin, end] = entries.equal_range(key);
+		for(auto it = begin; it != end; ++it) {
+			Entry& entry = it->second;
+			const CursorShape& shape = *entry.shape;
+			if(shape.width == width && shape.height == height && shape.hotX == hotX && shape.hotY == hotY
+					&& entry.wireData.size() == len && memcmp(entry.wireData.data(), data, len) == 0) {
+				entry.lastUse = ++useCounter;
+				hits++;
+				return entry.shape;
+			}
+		}
+
+		if(entries.size() >= MAX_ENTRIES) {
+			const auto oldest = std::min_element(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.second.lastUse < b.second.lastUse; });
+			entries.erase(oldest);
+		}
+		std::shared_ptr<const CursorShape> shape = std::make_shared<const CursorShape>(decode());
+		entries.emplace(key, Entry { std::vector<uint8_t>(data, data + len), shape, ++useCounter });
+		return shape;
+	}
+
+	inline size_t numHits() const {
+		return hits;
+	}
+
+	inline size_t size() const {
+		return entries.size();
+	}
+
+	inline void clear() {
+		entries.clear();
+	}
+};
\ No newline at end of file
@@ -0,0 +1,287 @@
+#pragma once
+
+
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <deque>
+
+#include "ByteStream.hpp"
+
+
+/**
+ * Properties of an emulated network link. Delays apply one-way, to each direction separately.
+*/
+struct LinkConditions {
+	uint32_t latencyUs = 0;
+	uint32_t jitterUs = 0; // uniformly distributed extra delay in [0, jitterUs]; packets are never reordered
+	uint64_t bytesPerSecond = 0; // bandwidth cap, 0 = unlimited
+	uint32_t minReadSize = 1; // each recv() returns between minReadSize and maxReadSize bytes (as far as delivered)
+	uint32_t maxReadSize = 64 * 1024;
+	uint64_t seed = 0; // jitter and read sizes are reproducible from the seed (separate generators)
+};
+
+
+// real time (default clock of EmulatedLink)
+struct SteadyLinkClock {
+	using time_point = std::chrono::steady_clock::time_point;
+
+	inline time_point now() const {
+		return std::chrono::steady_clock::now();
+	}
+
+	inline void sleepUntil(const time_point wakeup) const {
+		std::this_thread::sleep_until(wakeup);
+	}
+};
+
+
+// virtual time, e.g. for tests: waiting advances the clock instantly, so a run is fast and does not depend on scheduling
+class VirtualLinkClock {
+public:
+	using time_point = std::chrono::steady_clock::time_point;
+
+private:
+	time_point current { std::chrono::hours(1) }; // (not at the epoch: BasicVNC takes a timestamp of 0 for "never")
+
+public:
+	inline time_point now() const {
+		return current;
+	}
+
+	inline void sleepUntil(const time_point wakeup) {
+		current = std::max(current, wakeup);
+	}
+
+	inline void advance(const std::chrono::steady_clock::duration duration) {
+		current += duration;
+	}
+};
+
+
+// the time of an EmulatedLink as clock of BasicVNC (BasicVNC<Link, LinkTime<Link>>), so RTT, pacing, fences and budgets follow the link's clock
+template<typename Link>
+class LinkTime {
+private:
+	const Link& link;
+
+public:
+	inline explicit LinkTime(const Link& link):
+			link(link) {}
+
+	inline size_t now() const {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(link.clock().now().time_since_epoch()).count();
+	}
+
+	inline size_t frequency() const {
+		return 1'000'000'000;
+	}
+};
+
+
+/**
+ * Wraps another transport and makes it behave like a slow / bad network link:
+ * latency, jitter and bandwidth caps in both directions, plus fragmented reads (down to single bytes).
+ * Runs entirely in-process; received data is split into packets, each stamped with the time it may be handed out.
+ * Sends are queued and forwarded to the inner transport once due (checked on every call).
+ * Time comes from LinkClock (SteadyLinkClock or VirtualLinkClock); read sizes are drawn from their own random generator.
+ * Note that nativeHandle() reports readiness of the inner transport, not of the emulated link.
+*/
+template<typename Inner, typename LinkClock = SteadyLinkClock>
+class EmulatedLink : public ByteStream<EmulatedLink<Inner, LinkClock>> {
+private:
+	using TimePoint = typename LinkClock::time_point;
+
+	static constexpr size_t PACKET_SIZE = 1460; // payload of a typical TCP segment
+	static constexpr size_t RECEIVE_WINDOW = 4 * 1024 * 1024; // stop pulling from the inner transport while this much is in flight
+	static constexpr auto MAX_SLEEP = std::chrono::milliseconds(1); // granularity for noticing newly arrived data while waiting
+
+	struct Packet {
+		TimePoint due;
+		std::vector<uint8_t> bytes;
+		size_t pos = 0;
+	};
+
+	struct Direction { // one-way delay line
+		std::deque<Packet> packets;
+		size_t queuedBytes = 0;
+		TimePoint linkFree {}; // end of the last packet's transmission (bandwidth cap)
+	};
+
+	Inner link;
+	LinkConditions conditions;
+
+	mutable LinkClock linkClock;
+	mutable std::mt19937_64 delayRng;
+	mutable std::mt19937_64 readRng; // separate, so the read sizes do not depend on the number of packets sent
+	mutable Direction incoming;
+	mutable Direction outgoing;
+	mutable std::vector<uint8_t> pullBuffer;
+	mutable std::exception_ptr innerError; // raised once all data received before it was handed out
+
+public:
+	template<typename... InnerArgs>
+	inline explicit EmulatedLink(const LinkConditions& conditions, InnerArgs&&... innerArgs):
+			link(std::forward<InnerArgs>(innerArgs)...),
+			conditions(conditions),
+			linkClock{},
+			delayRng(conditions.seed),
+			readRng(conditions.seed ^ 0x9E3779B97F4A7C15ull),
+			pullBuffer(64 * 1024) {
+		if(this->conditions.minReadSize == 0)
+			this->conditions.minReadSize = 1;
+		this->conditions.maxReadSize = std::max(this->conditions.maxReadSize, this->conditions.minReadSize);
+	}
+
+	inline void close() const {
+		while(!outgoing.packets.empty()) { // deliver what was sent before closing
+			linkClock.sleepUntil(outgoing.packets.front().due);
+			flushSends();
+		}
+		link.close();
+	}
+
+	inline auto nativeHandle() const {
+		return link.nativeHandle();
+	}
+
+	inline const Inner& inner() const {
+		return link;
+	}
+
+	inline const LinkConditions& linkConditions() const {
+		return conditions;
+	}
+
+	inline LinkClock& clock() const {
+		return linkClock;
+	}
+
+
+	// -- sending:
+	inline void send(const void *const buffer, const int buffer_size) const {
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(buffer);
+		enqueue(outgoing, bytes, buffer_size, linkClock.now());
+		flushSends();
+	}
+
+	// packets not yet due stay on the emulated link
+	inline void flush() const {
+		flushSends();
+		link.flush();
+	}
+
+
+	// -- receiving:
+	inline bool dataAvailable() const {
+		flushSends();
+		pullAvailable();
+		return (!incoming.packets.empty() && incoming.packets.front().due <= linkClock.now()) || (incoming.packets.empty() && innerError);
+	}
+
+	inline int recv(void *const buffer, const int buffer_size) const {
+		for(;;) {
+			flushSends();
+			pullAvailable();
+
+			const TimePoint now = linkClock.now();
+			if(!incoming.packets.empty() && incoming.packets.front().due <= now)
+				return deliver(reinterpret_cast<uint8_t*>(buffer), buffer_size);
+
+			if(incoming.packets.empty() && innerError)
+				std::rethrow_exception(innerError);
+
+			if(incoming.packets.empty() && outgoing.packets.empty()) {
+				pullBlocking();
+				continue;
+			}
+
+			TimePoint wakeup = now + MAX_SLEEP;
+			if(!incoming.packets.empty())
+				wakeup = std::min(wakeup, incoming.packets.front().due);
+			if(!outgoing.packets.empty())
+				wakeup = std::min(wakeup, outgoing.packets.front().due);
+			linkClock.sleepUntil(wakeup);
+		}
+	}
+
+private:
+	inline std::chrono::microseconds randomDelay() const {
+		uint64_t delayUs = conditions.latencyUs;
+		if(conditions.jitterUs > 0)
+			delayUs += std::uniform_int_distribution<uint32_t>(0, conditions.jitterUs)(delayRng);
+		return std::chrono::microseconds(delayUs);
+	}
+
+	// splits the data into packets and schedules them
+	inline void enqueue(Direction& direction, const uint8_t* bytes, size_t size, const TimePoint sentAt) const {
+		while(size > 0) {
+			const size_t len = std::min(size, PACKET_SIZE);
+
+			TimePoint due = sentAt;
+			if(conditions.bytesPerSecond > 0) {
+				direction.linkFree = std::max(direction.linkFree, sentAt) + std::chrono::nanoseconds(len * 1000000000ull / conditions.bytesPerSecond);
+				due = direction.linkFree;
+			}
+			due += randomDelay();
+			if(!direction.packets.empty())
+				due = std::max(due, direction.packets.back().due); // in order, like TCP
+
+			direction.packets.push_back(Packet { due, std::vector<uint8_t>(bytes, bytes + len) });
+			direction.queuedBytes += len;
+			bytes += len;
+			size -= len;
+		}
+	}
+
+	inline void flushSends() const {
+		const TimePoint now = linkClock.now();
+		while(!outgoing.packets.empty() && outgoing.packets.front().due <= now) {
+			const Packet& packet = outgoing.packets.front();
+			link.send(packet.bytes.data(), packet.bytes.size());
+			outgoing.queuedBytes -= packet.bytes.size();
+			outgoing.packets.pop_front();
+		}
+	}
+
+	inline void pullBlocking() const {
+		try {
+			const int len = link.recv(pullBuffer.data(), pullBuffer.size());
+			enqueue(incoming, pullBuffer.data(), len, linkClock.now());
+		} catch(...) {
+			innerError = std::current_exception();
+		}
+	}
+
+	inline void pullAvailable() const {
+		while(!innerError && incoming.queuedBytes < RECEIVE_WINDOW && link.dataAvailable())
+			pullBlocking();
+	}
+
+	inline int deliver(uint8_t *const buffer, const int buffer_size) const {
+		const size_t wanted = std::uniform_int_distribution<uint32_t>(conditions.minReadSize, conditions.maxReadSize)(readRng);
+
+		const TimePoint now = linkClock.now();
+		size_t len = 0;
+		while(len < std::min<size_t>(wanted, buffer_size) && !incoming.packets.empty() && incoming.packets.front().due <= now) {
+			Packet& packet = incoming.packets.front();
+			const size_t part = std::min(std::min<size_t>(wanted, buffer_size) - len, packet.bytes.size() - packet.pos);
+			memcpy(buffer + len, packet.bytes.data() + packet.pos, part);
+			packet.pos += part;
+			len += part;
+			incoming.queuedBytes -= part;
+
+			if(packet.pos == packet.bytes.size())
+				incoming.packets.pop_front();
+		}
+
+		return len;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+
+
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <exception>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+
+/**
+ * epoll based readiness loop (Linux only) for driving many VNC connections from a single thread.
+ * Handlers are level triggered: a connection that still has unread data is reported again on the next poll().
+ * A handler that returns true stopped with data left over where epoll cannot see it (e.g. in the receive buffer of the
+ * connection, after its UpdateBudget ran out); it is dispatched again on the next poll(), which then does not wait.
+*/
+class EventLoop {
+public:
+	using ReadableHandler = std::function<bool()>; // returns whether data is left over
+	using ErrorHandler = std::function<void(const std::exception&)>;
+
+private:
+	struct Handler {
+		ReadableHandler onReadable;
+		ErrorHandler onError;
+	};
+
+	static constexpr size_t MAX_EVENTS_PER_POLL = 64;
+
+private:
+	int epollFd;
+	std::unordered_map<int, Handler> handlers;
+	std::unordered_set<int> pending; // handlers that returned with data left over
+	bool running;
+
+public:
+	inline EventLoop():
+			handlers{},
+			running(false) {
+		epollFd = epoll_create1(EPOLL_CLOEXEC);
+		if(epollFd < 0)
+			throw std::runtime_error("epoll_create1 failed: " + std::string(strerror(errno)));
+	}
+
+	EventLoop(const EventLoop&) = delete;
+	EventLoop& operator=(const EventLoop&) = delete;
+
+	inline ~EventLoop() {
+		::close(epollFd);
+	}
+
+public:
+	/**
+	 * Calls onReadable whenever fd has data (or a pending hangup / error).
+	 * If onReadable throws, fd is removed from the loop and the exception is handed to onError (or rethrown if there is none).
+	*/
+	inline void add(const int fd, ReadableHandler onReadable, ErrorHandler onError = {}) {
+		epoll_event event {};
+		event.events = EPOLLIN | EPOLLRDHUP;
+		event.data.fd = fd;
+
+		if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+			throw std::runtime_error("epoll_ctl(ADD) failed: " + std::string(strerror(errno)));
+
+		handlers[fd] = Handler { std::move(onReadable), std::move(onError) };
+	}
+
+	/**
+	 * Convenience overload: processes server messages of a VNC connection whenever its nativeHandle() becomes readable.
+	 * Dispatched once on the next poll() regardless, for anything the handshake left in the transport's buffers.
+	*/
+	template<typename Connection>
+	inline void add(Connection& connection, ErrorHandler onError = {}) {
+		add(connection.nativeHandle(), [&connection]() { return connection.recvUpdates().budgetExhausted; }, std::move(onError));
+		pending.insert(connection.nativeHandle());
+	}
+
+	inline void remove(const int fd) {
+		if(handlers.erase(fd) == 0)
+			return;
+		pending.erase(fd);
+
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr); // fd may already be closed, which removes it implicitly
+	}
+
+	inline size_t size() const {
+		return handlers.size();
+	}
+
+	/**
+	 * Waits up to timeoutMs milliseconds (-1 = forever; not at all while data is left over) and dispatches all ready connections,
+	 * plus those with data left over. Returns the number of dispatched handlers.
+	*/
+	inline size_t poll(const int timeoutMs) {
+		std::array<epoll_event, MAX_EVENTS_PER_POLL> events;
+
+		int numReady;
+		while((numReady = epoll_wait(epollFd, events.data(), events.size(), pending.empty() ? timeoutMs : 0)) < 0)
+			if(errno != EINTR)
+				throw std::runtime_error("epoll_wait failed: " + std::string(strerror(errno)));
+
+		std::vector<int> ready(pending.begin(), pending.end());
+		pending.clear();
+		for(int i = 0; i < numReady; i++)
+			if(std::find(ready.begin(), ready.end(), events[i].data.fd) == ready.end())
+				ready.push_back(events[i].data.fd);
+
+		size_t numDispatched = 0;
+		for(const int fd : ready) {
+			const auto it = handlers.find(fd);
+			if(it == handlers.end()) // removed by an earlier handler of this batch
+				continue;
+
+			const Handler handler = it->second; // copy; the handler may remove itself
+
+			try {
+				if(handler.onReadable() && handlers.count(fd)) // (unless it removed itself)
+					pending.insert(fd);
+			} catch(const std::exception& e) {
+				remove(fd);
+				if(!handler.onError)
+					throw;
+				handler.onError(e);
+			}
+
+			numDispatched++;
+		}
+
+		return numDispatched;
+	}
+
+	inline void run() {
+		running = true;
+		while(running && !handlers.empty())
+			poll(-1);
+	}
+
+	inline void stop() {
+		running = false;
+	}
+};
\ No newline at end of file
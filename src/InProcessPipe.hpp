@@ -0,0 +1,135 @@
+#pragma once
+
+
+#include <condition_variable>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+#include "ByteStream.hpp"
+
+
+/**
+ * One endpoint of a bidirectional in-process byte pipe, for servers that live in the same process as the viewer.
+ * Each direction is a bounded ring buffer: writers block while it is full, readers block while it is empty,
+ * recvChunk() hands out views straight into the ring (released on the next receive call).
+ * Both endpoints may be used from different threads; a single endpoint is not thread safe.
+*/
+class InProcessPipe : public ByteStream<InProcessPipe> {
+private:
+	struct Channel {
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::vector<uint8_t> ring;
+		size_t head = 0; // total bytes released by the reader
+		size_t tail = 0; // total bytes written
+		size_t viewed = 0; // bytes after head handed out by recvChunk() but not released yet
+		bool closed = false;
+
+		inline explicit Channel(const size_t capacity):
+			ring(capacity) { }
+	};
+
+public:
+	static constexpr size_t DEFAULT_CAPACITY = 1024 * 1024;
+
+private:
+	std::shared_ptr<Channel> in;
+	std::shared_ptr<Channel> out;
+
+private:
+	inline InProcessPipe(std::shared_ptr<Channel> in, std::shared_ptr<Channel> out):
+		in(std::move(in)), out(std::move(out)) { }
+
+public:
+	// creates two connected endpoints
+	static inline std::pair<InProcessPipe, InProcessPipe> create(const size_t capacity = DEFAULT_CAPACITY) {
+		const std::shared_ptr<Channel> a = std::make_shared<Channel>(capacity);
+		const std::shared_ptr<Channel> b = std::make_shared<Channel>(capacity);
+		return { InProcessPipe(a, b), InProcessPipe(b, a) };
+	}
+
+	// the peer reads the remaining data followed by end of stream; its writes fail from now on
+	inline void close() const {
+		for(Channel *const channel : { in.get(), out.get() }) {
+			std::lock_guard<std::mutex> lock(channel->mutex);
+			channel->closed = true;
+			channel->changed.notify_all();
+		}
+	}
+
+
+	// -- sending:
+	inline void send(const void *const buffer, const int buffer_size) const {
+		Channel& channel = *out;
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(buffer);
+		size_t left = buffer_size;
+
+		std::unique_lock<std::mutex> lock(channel.mutex);
+		while(left > 0) {
+			channel.changed.wait(lock, [&]() { return channel.closed || channel.tail - channel.head < channel.ring.size(); });
+			if(channel.closed)
+				throw std::runtime_error("send(): failed to send entire packet: pipe closed");
+
+			const size_t capacity = channel.ring.size();
+			const size_t writePos = channel.tail % capacity;
+			const size_t len = std::min({ left, capacity - (channel.tail - channel.head), capacity - writePos });
+			memcpy(channel.ring.data() + writePos, bytes, len);
+			channel.tail += len;
+			bytes += len;
+			left -= len;
+			channel.changed.notify_all();
+		}
+	}
+
+
+	// -- receiving:
+	inline bool dataAvailable() const {
+		std::lock_guard<std::mutex> lock(in->mutex);
+		return in->tail > in->head + in->viewed || in->closed;
+	}
+
+	inline int recv(void *const buffer, const int buffer_size) const {
+		const Chunk chunk = recvChunk(buffer_size);
+		memcpy(buffer, chunk.first, chunk.second);
+		release();
+		return chunk.second;
+	}
+
+	// zero-copy: view into the ring buffer, valid until the next receive call
+	inline Chunk recvChunk(const size_t maxLen) const {
+		Channel& channel = *in;
+
+		std::unique_lock<std::mutex> lock(channel.mutex);
+		releaseLocked(channel);
+		channel.changed.wait(lock, [&]() { return channel.closed || channel.tail > channel.head; });
+		if(channel.tail == channel.head)
+			throw std::runtime_error("recv(): Connection closing...");
+
+		const size_t capacity = channel.ring.size();
+		const size_t readPos = channel.head % capacity;
+		const size_t len = std::min({ maxLen, channel.tail - channel.head, capacity - readPos });
+		channel.viewed = len;
+		return Chunk(channel.ring.data() + readPos, len);
+	}
+
+private:
+	inline void release() const {
+		std::lock_guard<std::mutex> lock(in->mutex);
+		releaseLocked(*in);
+	}
+
+	static inline void releaseLocked(Channel& channel) {
+		if(channel.viewed == 0)
+			return;
+
+		channel.head += channel.viewed;
+		channel.viewed = 0;
+		channel.changed.notify_all();
+	}
+};
\ No newline at end of file
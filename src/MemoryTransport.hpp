@@ -0,0 +1,204 @@
+#pragma once
+
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
+#include "ByteStream.hpp"
+
+
+/**
+ * Replays a recorded server-to-client byte stream from memory.
+ * Everything the client sends is collected in sentData() (e.g. for checking the handshake replies).
+ * Reaching the end of the data behaves like the server closing the connection.
+*/
+class MemoryTransport : public ByteStream<MemoryTransport> {
+private:
+	std::vector<uint8_t> storage; // only used if the transport owns its data
+	const uint8_t* data;
+	size_t size;
+	mutable size_t pos;
+	mutable std::vector<uint8_t> sent;
+
+public:
+	// owning: takes the bytes
+	inline explicit MemoryTransport(std::vector<uint8_t> bytes):
+			storage(std::move(bytes)),
+			data(storage.data()),
+			size(storage.size()),
+			pos(0),
+			sent{} {
+	}
+
+	// non-owning: the memory has to outlive the transport
+	inline MemoryTransport(const void *const bytes, const size_t size):
+			storage{},
+			data(reinterpret_cast<const uint8_t*>(bytes)),
+			size(size),
+			pos(0),
+			sent{} {
+	}
+
+	MemoryTransport(const MemoryTransport&) = delete;
+	MemoryTransport& operator=(const MemoryTransport&) = delete;
+	MemoryTransport(MemoryTransport&&) = default; // moving a vector keeps its buffer, so data stays valid
+
+	inline void close() const {
+	}
+
+
+	// -- sending:
+	inline void send(const void *const buffer, const int buffer_size) const {
+		const uint8_t *const bytes = reinterpret_cast<const uint8_t*>(buffer);
+		sent.insert(sent.end(), bytes, bytes + buffer_size);
+	}
+
+	inline const std::vector<uint8_t>& sentData() const {
+		return sent;
+	}
+
+
+	// -- receiving:
+	inline bool dataAvailable() const {
+		return pos < size;
+	}
+
+	inline int recv(void *const buffer, const int buffer_size) const {
+		const Chunk chunk = recvChunk(buffer_size);
+		memcpy(buffer, chunk.first, chunk.second);
+		return chunk.second;
+	}
+
+	// zero-copy: views directly into the replayed data
+	inline Chunk recvChunk(const size_t maxLen) const {
+		if(pos >= size)
+			throw std::runtime_error("recv(): Connection closing..."); // end of recording
+
+		const size_t len = std::min(maxLen, size - pos);
+		const Chunk chunk(data + pos, len);
+		pos += len;
+		return chunk;
+	}
+
+	inline size_t bytesLeft() const {
+		return size - pos;
+	}
+
+	// start replaying from the beginning again
+	inline void rewind() {
+		pos = 0;
+		sent.clear();
+	}
+};
+
+
+/**
+ * Read-only memory mapping of a whole file (RAII)
+*/
+class MappedFile {
+private:
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#endif
+	void* view;
+	size_t length;
+
+public:
+	inline explicit MappedFile(const std::string& path):
+			view(nullptr),
+			length(0) {
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if(file == INVALID_HANDLE_VALUE)
+			throw std::runtime_error("could not open \"" + path + "\": " + std::to_string(GetLastError()));
+
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(file, &fileSize);
+		length = fileSize.QuadPart;
+
+		mapping = nullptr;
+		if(length == 0)
+			return;
+
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(mapping == nullptr) {
+			CloseHandle(file);
+			throw std::runtime_error("could not map \"" + path + "\": " + std::to_string(GetLastError()));
+		}
+
+		view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if(view == nullptr) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			throw std::runtime_error("could not map \"" + path + "\": " + std::to_string(GetLastError()));
+		}
+#else
+		const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if(fd < 0)
+			throw std::runtime_error("could not open \"" + path + "\": " + std::string(strerror(errno)));
+
+		struct stat fileStat;
+		if(fstat(fd, &fileStat) < 0) {
+			const int error = errno;
+			::close(fd);
+			throw std::runtime_error("could not stat \"" + path + "\": " + std::string(strerror(error)));
+		}
+		length = fileStat.st_size;
+
+		if(length > 0) {
+			view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+			if(view == MAP_FAILED) {
+				const int error = errno;
+				::close(fd);
+				throw std::runtime_error("could not map \"" + path + "\": " + std::string(strerror(error)));
+			}
+			madvise(view, length, MADV_SEQUENTIAL);
+		}
+
+		::close(fd); // the mapping keeps the file referenced
+#endif
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	inline ~MappedFile() {
+#ifdef _WIN32
+		if(view) UnmapViewOfFile(view);
+		if(mapping) CloseHandle(mapping);
+		CloseHandle(file);
+#else
+		if(view) munmap(view, length);
+#endif
+	}
+
+	inline const uint8_t* bytes() const { return reinterpret_cast<const uint8_t*>(view); }
+	inline size_t size() const { return length; }
+};
+
+
+/**
+ * Replays a recorded server-to-client byte stream straight out of a memory-mapped file.
+*/
+class MappedFileTransport : private MappedFile, public MemoryTransport {
+public:
+	inline explicit MappedFileTransport(const std::string& path):
+			MappedFile(path),
+			MemoryTransport(MappedFile::bytes(), MappedFile::size()) {
+	}
+};
\ No newline at end of file
@@ -0,0 +1,108 @@
+#pragma once
+
+
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+
+#include "ByteStream.hpp"
+
+
+/**
+ * Byte-stream transport over a pair of POSIX file descriptors:
+ * anonymous pipes, FIFOs, stdin / stdout of a tunnel process (e.g. "ssh host nc localhost 5900"), ...
+ * readFd and writeFd may be the same descriptor. Blocking and non-blocking descriptors are both supported.
+*/
+class PipeTransport : public ByteStream<PipeTransport> {
+public:
+	using NativeHandle = int;
+
+private:
+	int readFd;
+	int writeFd;
+
+public:
+	inline PipeTransport(const int readFd, const int writeFd):
+			readFd(readFd),
+			writeFd(writeFd) {
+	}
+
+	inline void close() const {
+		if(::close(readFd) < 0)
+			throw std::runtime_error("close failed with error = " + std::string(strerror(errno)));
+
+		if(writeFd != readFd && ::close(writeFd) < 0)
+			throw std::runtime_error("close failed with error = " + std::string(strerror(errno)));
+	}
+
+	// readable end, e.g. for registering the connection with an EventLoop
+	inline NativeHandle nativeHandle() const {
+		return readFd;
+	}
+
+
+	// -- sending:
+	inline void send(const void *const buffer, const int buffer_size) const {
+		int len_sent = 0;
+		while(len_sent < buffer_size) {
+			const ssize_t iResult = ::write(writeFd, reinterpret_cast<const char*>(buffer) + len_sent, buffer_size - len_sent);
+
+			if(iResult >= 0) {
+				len_sent += iResult;
+				continue;
+			}
+
+			if(errno == EINTR)
+				continue;
+
+			if(errno == EAGAIN || errno == EWOULDBLOCK) {
+				waitFor(writeFd, POLLOUT);
+				continue;
+			}
+
+			throw std::runtime_error("send(): failed to send entire packet: " + std::string(strerror(errno)));
+		}
+	}
+
+
+	// -- receiving:
+	inline bool dataAvailable() const {
+		pollfd pfd { .fd = readFd, .events = POLLIN, .revents = 0 };
+		return ::poll(&pfd, 1, 0) > 0; // also true on hangup, so the following recv() reports it
+	}
+
+	inline int recv(void *const buffer, const int buffer_size) const {
+		for(;;) {
+			const ssize_t iResult = ::read(readFd, buffer, buffer_size);
+
+			if(iResult > 0)
+				return iResult;
+
+			if(iResult == 0)
+				throw std::runtime_error("recv(): Connection closing...");
+
+			if(errno == EINTR)
+				continue;
+
+			if(errno == EAGAIN || errno == EWOULDBLOCK) {
+				waitFor(readFd, POLLIN);
+				continue;
+			}
+
+			throw std::runtime_error("recv() failed: " + std::string(strerror(errno)));
+		}
+	}
+
+private:
+	static inline void waitFor(const int fd, const short events) {
+		pollfd pfd { .fd = fd, .events = events, .revents = 0 };
+		while(::poll(&pfd, 1, -1) < 0)
+			if(errno != EINTR)
+				throw std::runtime_error("poll() failed: " + std::string(strerror(errno)));
+	}
+};
\ No newline at end of file
@@ -0,0 +1,214 @@
+#pragma once
+
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PIXELFORMAT_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+/**
+ * Pixel formats the client can ask for with SetPixelFormat, as traits for the decoders of BasicVNC: the bytes of a pixel
+ * on the wire (and of the compressed CPIXEL of ZRLE / TRLE and TPIXEL of Tight), the RFB pixel format fields, and how a
+ * pixel lands in the framebuffer (Pixel). True colour formats expand into 32 bit framebuffer pixels
+ * (blue | green << 8 | red << 16); convert() does whole rows, with SSE2 where it pays off.
+ * All formats are little endian.
+*/
+
+// replicates the top bits of a component into the low bits (31 -> 255, 16 -> 132)
+template<unsigned BITS>
+static constexpr uint32_t expandComponent(const uint32_t value) {
+	uint32_t result = 0;
+	for(int shift = 8 - BITS; shift > -static_cast<int>(BITS); shift -= BITS)
+		result |= (shift >= 0) ? value << shift : value >> -shift;
+	return result & 0xFF;
+}
+
+// 32 bpp, depth 24: the default format of most servers; the framebuffer takes its bytes unchanged
+struct FormatBGRX32 {
+	using Pixel = uint32_t;
+	static constexpr size_t SIZE = 4;
+	static constexpr size_t CPIXEL_SIZE = 3; // the unused top byte is left out
+	static constexpr size_t TPIXEL_SIZE = 3; // red, green, blue
+	static constexpr bool TRUE_COLOR = true;
+	static constexpr bool DIRECT = true; // wire bytes are framebuffer bytes
+	static constexpr uint8_t BITS_PER_PIXEL = 32, DEPTH = 24;
+	static constexpr uint16_t RED_MAX = 255, GREEN_MAX = 255, BLUE_MAX = 255;
+	static constexpr uint8_t RED_SHIFT = 16, GREEN_SHIFT = 8, BLUE_SHIFT = 0;
+
+	static inline uint32_t readRaw(const uint8_t *const src) {
+		uint32_t pixel;
+		memcpy(&pixel, src, sizeof(pixel));
+		return pixel;
+	}
+	static inline Pixel fromRaw(const uint32_t raw) { return raw; }
+	static inline Pixel read(const uint8_t *const src) { return readRaw(src); }
+	static inline Pixel readCPixel(const uint8_t *const src) { return src[0] | src[1] << 8 | src[2] << 16; }
+	static inline Pixel readTPixel(const uint8_t *const src) { return src[0] << 16 | src[1] << 8 | src[2]; }
+
+	static inline void convert(const uint8_t *const src, Pixel *const dst, const size_t numPixels) {
+		memcpy(dst, src, numPixels * SIZE);
+	}
+};
+
+// 24 bpp, packed: blue, green, red (not in RFC 6143, but accepted by libvncserver and others)
+struct FormatPacked24 {
+	using Pixel = uint32_t;
+	static constexpr size_t SIZE = 3;
+	static constexpr size_t CPIXEL_SIZE = 3;
+	static constexpr size_t TPIXEL_SIZE = 3;
+	static constexpr bool TRUE_COLOR = true;
+	static constexpr bool DIRECT = false;
+	static constexpr uint8_t BITS_PER_PIXEL = 24, DEPTH = 24;
+	static constexpr uint16_t RED_MAX = 255, GREEN_MAX = 255, BLUE_MAX = 255;
+	static constexpr uint8_t RED_SHIFT = 16, GREEN_SHIFT = 8, BLUE_SHIFT = 0;
+
+	static inline uint32_t readRaw(const uint8_t *const src) { return src[0] | src[1] << 8 | src[2] << 16; }
+	static inline Pixel fromRaw(const uint32_t raw) { return raw; }
+	static inline Pixel read(const uint8_t *const src) { return readRaw(src); }
+	static inline Pixel readCPixel(const uint8_t *const src) { return readRaw(src); }
+	static inline Pixel readTPixel(const uint8_t *const src) { return readRaw(src); }
+
+	// SSE2: 4 pixels from 16 loaded bytes, gathered by byte shifts of 3, 6 and 9
+	static inline void convert(const uint8_t *const src, Pixel *const dst, const size_t numPixels) {
+		size_t i = 0;
+#ifdef PIXELFORMAT_SSE2
+		const __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+		for(; i + 6 <= numPixels; i += 4) { // reads 16 of the 18 bytes of 6 pixels
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+			const __m128i p01 = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));
+			const __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(_mm_unpacklo_epi64(p01, p23), mask));
+		}
+#endif
+		for(; i < numPixels; i++)
+			dst[i] = readRaw(src + i * 3);
+	}
+};
+
+// 16 bpp: red 5, green 6, blue 5 bits; half the bytes of 32 bpp
+struct FormatRGB565 {
+	using Pixel = uint32_t;
+	static constexpr size_t SIZE = 2;
+	static constexpr size_t CPIXEL_SIZE = 2;
+	static constexpr size_t TPIXEL_SIZE = 2;
+	static constexpr bool TRUE_COLOR = true;
+	static constexpr bool DIRECT = false;
+	static constexpr uint8_t BITS_PER_PIXEL = 16, DEPTH = 16;
+	static constexpr uint16_t RED_MAX = 31, GREEN_MAX = 63, BLUE_MAX = 31;
+	static constexpr uint8_t RED_SHIFT = 11, GREEN_SHIFT = 5, BLUE_SHIFT = 0;
+
+	static inline uint32_t readRaw(const uint8_t *const src) { return src[0] | src[1] << 8; }
+	static inline Pixel fromRaw(const uint32_t raw) {
+		return expandComponent<5>(raw & 31) | expandComponent<6>((raw >> 5) & 63) << 8 | expandComponent<5>(raw >> 11) << 16;
+	}
+	static inline Pixel read(const uint8_t *const src) { return fromRaw(readRaw(src)); }
+	static inline Pixel readCPixel(const uint8_t *const src) { return read(src); }
+	static inline Pixel readTPixel(const uint8_t *const src) { return read(src); }
+
+	// SSE2: 8 pixels per step, components widened by bit replication in 16 bit lanes
+	static inline void convert(const uint8_t *const src, Pixel *const dst, const size_t numPixels) {
+		size_t i = 0;
+#ifdef PIXELFORMAT_SSE2
+		const __m128i mask5 = _mm_set1_epi16(31);
+		const __m128i mask6 = _mm_set1_epi16(63);
+		for(; i + 8 <= numPixels; i += 8) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+			const __m128i r = _mm_srli_epi16(v, 11);
+			const __m128i g = _mm_and_si128(_mm_srli_epi16(v, 5), mask6);
+			const __m128i b = _mm_and_si128(v, mask5);
+			const __m128i r8 = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+			const __m128i g8 = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+			const __m128i b8 = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+			const __m128i bg = _mm_or_si128(b8, _mm_slli_epi16(g8, 8));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(bg, r8));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(bg, r8));
+		}
+#endif
+		for(; i < numPixels; i++)
+			dst[i] = read(src + i * 2);
+	}
+};
+
+// expansion of all 256 BGR233 pixels (a table lookup beats any arithmetic for 8 bit input)
+struct BGR233Table {
+	uint32_t pixels[256];
+	constexpr BGR233Table(): pixels{} {
+		for(uint32_t v = 0; v < 256; v++)
+			pixels[v] = expandComponent<2>(v >> 6) | expandComponent<3>((v >> 3) & 7) << 8 | expandComponent<3>(v & 7) << 16;
+	}
+};
+
+// 8 bpp true colour: blue 2 (top), green 3, red 3 (bottom) bits; a quarter of the bytes of 32 bpp
+struct FormatBGR233 {
+	using Pixel = uint32_t;
+	static constexpr size_t SIZE = 1;
+	static constexpr size_t CPIXEL_SIZE = 1;
+	static constexpr size_t TPIXEL_SIZE = 1;
+	static constexpr bool TRUE_COLOR = true;
+	static constexpr bool DIRECT = false;
+	static constexpr uint8_t BITS_PER_PIXEL = 8, DEPTH = 8;
+	static constexpr uint16_t RED_MAX = 7, GREEN_MAX = 7, BLUE_MAX = 3;
+	static constexpr uint8_t RED_SHIFT = 0, GREEN_SHIFT = 3, BLUE_SHIFT = 6;
+
+	static constexpr BGR233Table TABLE {};
+
+	static inline uint32_t readRaw(const uint8_t *const src) { return src[0]; }
+	static inline Pixel fromRaw(const uint32_t raw) { return TABLE.pixels[raw & 0xFF]; }
+	static inline Pixel read(const uint8_t *const src) { return TABLE.pixels[src[0]]; }
+	static inline Pixel readCPixel(const uint8_t *const src) { return read(src); }
+	static inline Pixel readTPixel(const uint8_t *const src) { return read(src); }
+
+	static inline void convert(const uint8_t *const src, Pixel *const dst, const size_t numPixels) {
+		for(size_t i = 0; i < numPixels; i++)
+			dst[i] = TABLE.pixels[src[i]];
+	}
+};
+
+// 8 bpp colour map: the framebuffer keeps the indices (see BasicVNC::colorMap())
+struct FormatIndexed8 {
+	using Pixel = uint8_t;
+	static constexpr size_t SIZE = 1;
+	static constexpr size_t CPIXEL_SIZE = 1;
+	static constexpr size_t TPIXEL_SIZE = 1;
+	static constexpr bool TRUE_COLOR = false;
+	static constexpr bool DIRECT = true;
+	static constexpr uint8_t BITS_PER_PIXEL = 8, DEPTH = 8;
+	static constexpr uint16_t RED_MAX = 0, GREEN_MAX = 0, BLUE_MAX = 0;
+	static constexpr uint8_t RED_SHIFT = 0, GREEN_SHIFT = 0, BLUE_SHIFT = 0;
+
+	static inline Pixel read(const uint8_t *const src) { return src[0]; }
+	static inline Pixel readCPixel(const uint8_t *const src) { return src[0]; }
+	static inline Pixel readTPixel(const uint8_t *const src) { return src[0]; }
+
+	static inline void convert(const uint8_t *const src, Pixel *const dst, const size_t numPixels) {
+		memcpy(dst, src, numPixels);
+	}
+};
+
+
+enum class WireFormat : uint8_t {
+	BGRX32,
+	PACKED24,
+	RGB565,
+	BGR233,
+	INDEXED8
+};
+
+// calls visit with the traits of a format (e.g. to instantiate a decoder for it)
+template<typename Visitor>
+inline decltype(auto) visitWireFormat(const WireFormat format, Visitor&& visit) {
+	switch(format) {
+		case WireFormat::PACKED24: return visit(FormatPacked24());
+		case WireFormat::RGB565:   return visit(FormatRGB565());
+		case WireFormat::BGR233:   return visit(FormatBGR233());
+		case WireFormat::INDEXED8: return visit(FormatIndexed8());
+		case WireFormat::BGRX32:
+		default:                   return visit(FormatBGRX32());
+	}
+}
\ No newline at end of file
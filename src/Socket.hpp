@@ -1,156 +1,262 @@
-#pragma once
-
-
-#include <stdexcept>
-#include <cstdint>
-#include <string>
-#include <vector>
-
-#include <winsock2.h>
-#include <ws2tcpip.h>
-
-
-/**
- * Simple Winsock2 Socket abstraction; probably not completely thread safe (Especially socket creation)
-*/
-class Socket {
-private:
-	static thread_local WSADATA wsaData;
-	static thread_local bool winSockInitialized;
-
-private:
-	SOCKET sock;
-
-public:
-	inline Socket(const std::string& address, const u_short port) {
-		int iResult = 0;
-
-		// Initialize Winsock
-		if(!winSockInitialized) {
-			iResult = WSAStartup(MAKEWORD(2, 2), &wsaData);
-			if (iResult != 0)
-				throw std::runtime_error("WSAStartup failed: " + std::to_string(iResult));
-			
-			winSockInitialized = true;
-		}
-
-		// create socket:
-		sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-		if (sock == INVALID_SOCKET)
-			throw std::runtime_error("socket function failed with error = " + std::to_string(WSAGetLastError()));
-
-		// connect to server
-		sockaddr_in clientService;
-		clientService.sin_family = AF_INET;
-		clientService.sin_port = htons(port);
-		inet_pton(AF_INET, address.c_str(), &clientService.sin_addr.s_addr);
-		printf("Init winsock succeed\n");
-
-		iResult = connect(sock, (SOCKADDR*)&clientService, sizeof(clientService));
-		if (iResult == SOCKET_ERROR)
-			throw std::runtime_error("connecting socket failed with error: " + std::to_string(WSAGetLastError()));
-	}
-
-	inline void close() const {
-		// close socket
-		if (int iResult = closesocket(sock) == SOCKET_ERROR)
-			throw std::runtime_error("closesocket failed with error = " + std::to_string(WSAGetLastError()));
-	}
-
-
-	// -- sending:
-	inline void send(const void *const buffer, const int buffer_size) const {
-		const int iResult = ::send(sock, reinterpret_cast<const char*>(buffer), buffer_size, 0);
-
-		if(iResult == buffer_size)
-			return;
-		
-		throw std::runtime_error("send(): failed to send entire packet");
-	}
-
-	template<typename T>
-	inline void sendPrimitive(const std::remove_cv_t<T>& val) const {
-		send(&val, sizeof(T));
-	}
-
-	inline void sendU8(const uint8_t val) const {
-		sendPrimitive<uint8_t>(val);
-	}
-
-	inline void sendU16(const uint16_t val) const {
-		sendPrimitive<uint16_t>(htons(val));
-	}
-
-	inline void sendS32(const int32_t val) const {
-		sendPrimitive<int32_t>(htonl(val));
-	}
-
-
-	// -- receiving:
-	inline bool dataAvailable() const {
-		fd_set set{};
-		FD_ZERO(&set);
-		FD_SET(sock, &set);
-		TIMEVAL timeVal { .tv_sec = 0, .tv_usec = 0 };
-
-		return select(0, &set, nullptr, nullptr, &timeVal);
-	}
-
-	inline int recv(void *const buffer, const int buffer_size) const {
-		const int iResult = ::recv(sock, reinterpret_cast<char*>(buffer), buffer_size, 0); // blocks and waits for data
-
-		if(iResult > 0)
-			return iResult;
-		
-		if(iResult < 0) {
-			closesocket(sock);
-			throw std::runtime_error("recv() failed: " + std::to_string(WSAGetLastError()));
-		}
-		
-		throw std::runtime_error("recv(): Connection closing..."); // iResult == 0
-	}
-
-	inline void recvExactly(void *const buffer, const size_t buffer_size) const {
-		size_t len_received = 0;
-		do {
-			len_received += recv(reinterpret_cast<char*>(buffer) + len_received, buffer_size - len_received);
-		} while(len_received < buffer_size);
-	}
-
-	inline std::string recvString(const size_t len) const {
-		std::vector<char> text(len);
-		recvExactly(text.data(), len);
-
-		std::string str;
-		str.append(text.data(), len);
-		return str;
-	}
-
-	template<typename T>
-	inline std::remove_cv_t<T> recvPrimitive() const {
-		std::remove_cv_t<T> res;
-
-		recvExactly(&res, sizeof(T));
-
-		return res;
-	}
-
-	inline uint8_t recvU8() const {
-		return recvPrimitive<uint8_t>();
-	}
-
-	inline uint16_t recvU16() const {
-		return ntohs(recvPrimitive<uint16_t>());
-	}
-
-	inline uint32_t recvU32() const {
-		return ntohl(recvPrimitive<uint32_t>());
-	}
-
-	inline int32_t recvS32() const {
-		return ntohl(recvPrimitive<int32_t>());
-	}
-};
-
-thread_local WSADATA Socket::wsaData = {0};
-thread_local bool Socket::winSockInitialized = false;
\ No newline at end of file
+#pragma once
+
+
+#include <stdexcept>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ByteStream.hpp"
+
+#ifdef _WIN32
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+	#include <afunix.h>
+	#include <cstring>
+#else
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <netinet/in.h>
+	#include <arpa/inet.h>
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <cerrno>
+	#include <cstring>
+#endif
+
+
+/**
+ * Simple TCP / unix domain Socket abstraction (Winsock2 on Windows, non-blocking BSD sockets everywhere else);
+ * probably not completely thread safe (Especially socket creation)
+*/
+class Socket : public ByteStream<Socket> {
+public:
+#ifdef _WIN32
+	using NativeHandle = SOCKET;
+#else
+	using NativeHandle = int;
+#endif
+
+private:
+#ifdef _WIN32
+	static thread_local WSADATA wsaData;
+	static thread_local bool winSockInitialized;
+#endif
+
+private:
+	NativeHandle sock;
+
+public:
+#ifdef _WIN32
+	inline Socket(const std::string& address, const uint16_t port) {
+		initWinsock();
+
+		// connect to server
+		sockaddr_in clientService;
+		clientService.sin_family = AF_INET;
+		clientService.sin_port = htons(port);
+		inet_pton(AF_INET, address.c_str(), &clientService.sin_addr.s_addr);
+
+		connectTo(AF_INET, IPPROTO_TCP, (SOCKADDR*)&clientService, sizeof(clientService));
+	}
+
+	// unix domain socket (Windows 10 1803+), e.g. QEMU's -vnc unix:<path>
+	inline explicit Socket(const std::string& unixPath) {
+		initWinsock();
+
+		sockaddr_un serverPath {};
+		serverPath.sun_family = AF_UNIX;
+		if(unixPath.size() >= sizeof(serverPath.sun_path))
+			throw std::runtime_error("unix socket path too long: " + unixPath);
+		memcpy(serverPath.sun_path, unixPath.c_str(), unixPath.size() + 1);
+
+		connectTo(AF_UNIX, 0, (SOCKADDR*)&serverPath, sizeof(serverPath));
+	}
+#else
+	inline Socket(const std::string& address, const uint16_t port) {
+		sockaddr_in clientService {};
+		clientService.sin_family = AF_INET;
+		clientService.sin_port = htons(port);
+		if (inet_pton(AF_INET, address.c_str(), &clientService.sin_addr.s_addr) != 1)
+			throw std::runtime_error("invalid IPv4 address: " + address);
+
+		connectTo(AF_INET, IPPROTO_TCP, reinterpret_cast<sockaddr*>(&clientService), sizeof(clientService));
+	}
+
+	// unix domain socket, e.g. QEMU's -vnc unix:<path>
+	inline explicit Socket(const std::string& unixPath) {
+		sockaddr_un serverPath {};
+		serverPath.sun_family = AF_UNIX;
+		if(unixPath.size() >= sizeof(serverPath.sun_path))
+			throw std::runtime_error("unix socket path too long: " + unixPath);
+		memcpy(serverPath.sun_path, unixPath.c_str(), unixPath.size() + 1);
+
+		connectTo(AF_UNIX, 0, reinterpret_cast<sockaddr*>(&serverPath), sizeof(serverPath));
+	}
+#endif
+
+	inline void close() const {
+		// close socket
+#ifdef _WIN32
+		if (int iResult = closesocket(sock) == SOCKET_ERROR)
+			throw std::runtime_error("closesocket failed with error = " + std::to_string(WSAGetLastError()));
+#else
+		if (::close(sock) < 0)
+			throw std::runtime_error("close failed with error = " + std::string(strerror(errno)));
+#endif
+	}
+
+	// native socket handle, e.g. for registering the connection with an EventLoop
+	inline NativeHandle nativeHandle() const {
+		return sock;
+	}
+
+
+	// -- sending:
+#ifdef _WIN32
+	inline void send(const void *const buffer, const int buffer_size) const {
+		const int iResult = ::send(sock, reinterpret_cast<const char*>(buffer), buffer_size, 0);
+
+		if(iResult == buffer_size)
+			return;
+
+		throw std::runtime_error("send(): failed to send entire packet");
+	}
+#else
+	inline void send(const void *const buffer, const int buffer_size) const {
+		int len_sent = 0;
+		while(len_sent < buffer_size) {
+			const ssize_t iResult = ::send(sock, reinterpret_cast<const char*>(buffer) + len_sent, buffer_size - len_sent, MSG_NOSIGNAL);
+
+			if(iResult >= 0) {
+				len_sent += iResult;
+				continue;
+			}
+
+			if(errno == EINTR)
+				continue;
+
+			if(errno == EAGAIN || errno == EWOULDBLOCK) { // send buffer full; wait until the socket is writable again
+				waitFor(POLLOUT);
+				continue;
+			}
+
+			throw std::runtime_error("send(): failed to send entire packet: " + std::string(strerror(errno)));
+		}
+	}
+#endif
+
+	// -- receiving:
+#ifdef _WIN32
+	inline bool dataAvailable() const {
+		fd_set set{};
+		FD_ZERO(&set);
+		FD_SET(sock, &set);
+		TIMEVAL timeVal { .tv_sec = 0, .tv_usec = 0 };
+
+		return select(0, &set, nullptr, nullptr, &timeVal);
+	}
+
+	inline int recv(void *const buffer, const int buffer_size) const {
+		const int iResult = ::recv(sock, reinterpret_cast<char*>(buffer), buffer_size, 0); // blocks and waits for data
+
+		if(iResult > 0)
+			return iResult;
+
+		if(iResult < 0) {
+			closesocket(sock);
+			throw std::runtime_error("recv() failed: " + std::to_string(WSAGetLastError()));
+		}
+
+		throw std::runtime_error("recv(): Connection closing..."); // iResult == 0
+	}
+#else
+	inline bool dataAvailable() const {
+		pollfd pfd { .fd = sock, .events = POLLIN, .revents = 0 };
+		return ::poll(&pfd, 1, 0) > 0; // also true on hangup / error, so the following recv() reports it
+	}
+
+	inline int recv(void *const buffer, const int buffer_size) const {
+		for(;;) {
+			const ssize_t iResult = ::recv(sock, reinterpret_cast<char*>(buffer), buffer_size, 0);
+
+			if(iResult > 0)
+				return iResult;
+
+			if(iResult == 0)
+				throw std::runtime_error("recv(): Connection closing...");
+
+			if(errno == EINTR)
+				continue;
+
+			if(errno == EAGAIN || errno == EWOULDBLOCK) { // nothing buffered yet; block until data arrives
+				waitFor(POLLIN);
+				continue;
+			}
+
+			throw std::runtime_error("recv() failed: " + std::string(strerror(errno)));
+		}
+	}
+#endif
+
+private:
+#ifdef _WIN32
+	inline void initWinsock() {
+		// Initialize Winsock
+		if(!winSockInitialized) {
+			const int iResult = WSAStartup(MAKEWORD(2, 2), &wsaData);
+			if (iResult != 0)
+				throw std::runtime_error("WSAStartup failed: " + std::to_string(iResult));
+
+			winSockInitialized = true;
+		}
+	}
+
+	inline void connectTo(const int family, const int protocol, const SOCKADDR* address, const int addressLength) {
+		// create socket:
+		sock = socket(family, SOCK_STREAM, protocol);
+		if (sock == INVALID_SOCKET)
+			throw std::runtime_error("socket function failed with error = " + std::to_string(WSAGetLastError()));
+		printf("Init winsock succeed\n");
+
+		// connect to server
+		if (connect(sock, address, addressLength) == SOCKET_ERROR)
+			throw std::runtime_error("connecting socket failed with error: " + std::to_string(WSAGetLastError()));
+	}
+#else
+	inline void connectTo(const int family, const int protocol, const sockaddr* address, const socklen_t addressLength) {
+		// create socket:
+		sock = ::socket(family, SOCK_STREAM | SOCK_CLOEXEC, protocol);
+		if (sock < 0)
+			throw std::runtime_error("socket function failed with error = " + std::string(strerror(errno)));
+
+		// connect to server (blocking, the socket is switched to non-blocking mode afterwards)
+		if (::connect(sock, address, addressLength) < 0) {
+			const int error = errno;
+			::close(sock);
+			throw std::runtime_error("connecting socket failed with error: " + std::string(strerror(error)));
+		}
+
+		const int flags = fcntl(sock, F_GETFL, 0);
+		if (flags < 0 || fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0) {
+			const int error = errno;
+			::close(sock);
+			throw std::runtime_error("could not make socket non-blocking: " + std::string(strerror(error)));
+		}
+	}
+
+	// block until the non-blocking socket is ready for the given poll events
+	inline void waitFor(const short events) const {
+		pollfd pfd { .fd = sock, .events = events, .revents = 0 };
+		while(::poll(&pfd, 1, -1) < 0)
+			if(errno != EINTR)
+				throw std::runtime_error("poll() failed: " + std::string(strerror(errno)));
+	}
+#endif
+};
+
+#ifdef _WIN32
+thread_local WSADATA Socket::wsaData = {0};
+thread_local bool Socket::winSockInitialized = false;
+#endif
\ No newline at end of file
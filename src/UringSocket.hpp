@@ -0,0 +1,459 @@
+#pragma once
+
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+
+#include "ByteStream.hpp"
+
+
+/**
+ * io_uring TCP transport (Linux >= 6.0) with the same interface as Socket.
+ * All data is received by a single multishot recv into a registered provided-buffer ring;
+ * recvChunk() hands out views straight into those ring buffers, which are given back to the kernel once consumed.
+ * Outgoing messages are collected and submitted as one send SQE per flush() (BasicVNC flushes after each message); messages flushed
+ * while a send is in flight go out together once it completes.
+ * nativeHandle() is the ring's fd, which polls readable whenever completions are waiting: the socket itself is drained by the
+ * multishot recv, and send completions have to be reaped to keep queued messages moving.
+*/
+class UringSocket : public ByteStream<UringSocket> {
+public:
+	using NativeHandle = int;
+
+private:
+	static constexpr unsigned RING_ENTRIES = 16;
+	static constexpr uint16_t NUM_BUFFERS = 64; // must be a power of 2
+	static constexpr uint32_t BUFFER_SIZE = 64 * 1024;
+	static constexpr uint16_t BUFFER_GROUP = 0;
+	static constexpr size_t SEND_FLUSH_THRESHOLD = 16 * 1024;
+
+	static constexpr uint64_t TAG_RECV = 1;
+	static constexpr uint64_t TAG_SEND = 2;
+
+	struct Segment { // received, not yet consumed part of a ring buffer
+		uint16_t bufferId;
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	struct Ring {
+		int fd = -1;
+
+		// submission / completion queues (shared with the kernel):
+		uint8_t* sqRing = nullptr;
+		uint8_t* cqRing = nullptr;
+		size_t sqRingSize = 0;
+		size_t cqRingSize = 0;
+		io_uring_sqe* sqes = nullptr;
+		size_t sqesSize = 0;
+		unsigned sqEntries = 0;
+		unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+		unsigned *cqHead, *cqTail, *cqMask;
+		io_uring_cqe* cqes;
+		unsigned numUnsubmitted = 0;
+
+		// provided buffers:
+		io_uring_buf* bufRing = nullptr; // io_uring_buf_ring; addressed as plain array since its flex-array member has a different offset in C++
+		size_t bufRingSize = 0;
+		uint8_t* bufferMemory = nullptr;
+		uint16_t bufRingTail = 0;
+
+		// receive state:
+		std::deque<Segment> segments;
+		int deferredBufferId = -1; // buffer behind the last recvChunk() view; recycled on the next receive call
+		bool recvArmed = false;
+		bool peerClosed = false;
+		int recvError = 0;
+
+		// send state:
+		std::vector<uint8_t> sendQueue;
+		std::vector<uint8_t> sendInFlight; // owned by the kernel until its completion arrives
+		size_t sendInFlightOffset = 0;
+		bool sendBusy = false;
+		int sendError = 0;
+
+		inline ~Ring() {
+			if(fd >= 0) ::close(fd); // cancels the multishot recv before its buffers are unmapped
+			if(sqes) munmap(sqes, sqesSize);
+			if(cqRing && cqRing != sqRing) munmap(cqRing, cqRingSize);
+			if(sqRing) munmap(sqRing, sqRingSize);
+			if(bufRing) munmap(bufRing, bufRingSize);
+			if(bufferMemory) munmap(bufferMemory, size_t(NUM_BUFFERS) * BUFFER_SIZE);
+		}
+	};
+
+private:
+	int sock;
+	std::unique_ptr<Ring> ring;
+
+public:
+	inline UringSocket(const std::string& address, const uint16_t port):
+			sock(-1),
+			ring(std::make_unique<Ring>()) {
+
+		// create socket:
+		sock = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (sock < 0)
+			throw std::runtime_error("socket function failed with error = " + std::string(strerror(errno)));
+
+		// connect to server
+		sockaddr_in clientService {};
+		clientService.sin_family = AF_INET;
+		clientService.sin_port = htons(port);
+		if (inet_pton(AF_INET, address.c_str(), &clientService.sin_addr.s_addr) != 1) {
+			::close(sock);
+			throw std::runtime_error("invalid IPv4 address: " + address);
+		}
+
+		if (::connect(sock, reinterpret_cast<sockaddr*>(&clientService), sizeof(clientService)) < 0) {
+			const int error = errno;
+			::close(sock);
+			throw std::runtime_error("connecting socket failed with error: " + std::string(strerror(error)));
+		}
+
+		try {
+			setupRing();
+			setupBufferRing();
+		} catch(...) {
+			::close(sock);
+			throw;
+		}
+	}
+
+	inline void close() const {
+		flush();
+		while(ring->sendBusy) // let queued input events reach the server
+			waitForCompletions();
+
+		::shutdown(sock, SHUT_RDWR); // the armed multishot recv keeps the socket open past close() otherwise
+		if (::close(sock) < 0)
+			throw std::runtime_error("close failed with error = " + std::string(strerror(errno)));
+	}
+
+	inline NativeHandle nativeHandle() const {
+		return ring->fd;
+	}
+
+
+	// -- sending:
+	inline void send(const void *const buffer, const int buffer_size) const {
+		if(ring->sendError)
+			throw std::runtime_error("send(): failed to send entire packet: " + std::string(strerror(ring->sendError)));
+
+		const uint8_t *const bytes = reinterpret_cast<const uint8_t*>(buffer);
+		ring->sendQueue.insert(ring->sendQueue.end(), bytes, bytes + buffer_size);
+
+		if(ring->sendQueue.size() >= SEND_FLUSH_THRESHOLD)
+			flush();
+	}
+
+	// submit all queued messages as a single send
+	inline void flush() const {
+		Ring& r = *ring;
+		if(r.sendBusy || r.sendQueue.empty()) // queued data follows once the in-flight send completes
+			return;
+
+		std::swap(r.sendQueue, r.sendInFlight);
+		r.sendQueue.clear();
+		r.sendInFlightOffset = 0;
+		r.sendBusy = true;
+		prepareSend();
+		submit(0);
+	}
+
+
+	// -- receiving:
+	inline bool dataAvailable() const {
+		flush();
+		recycleDeferredBuffer();
+		reapCompletions();
+
+		if(!ring->segments.empty() || ring->peerClosed || ring->recvError)
+			return true;
+
+		if(!ring->recvArmed) { // (re-)arm and pick up anything that is already queued in the socket
+			armRecv();
+			submit(0);
+			reapCompletions();
+		}
+
+		return !ring->segments.empty() || ring->peerClosed || ring->recvError;
+	}
+
+	inline int recv(void *const buffer, const int buffer_size) const {
+		waitForData();
+
+		Segment& segment = ring->segments.front();
+		const uint32_t len = std::min<uint32_t>(buffer_size, segment.length);
+		memcpy(buffer, bufferAddress(segment.bufferId) + segment.offset, len);
+		segment.offset += len;
+		segment.length -= len;
+
+		if(segment.length == 0) {
+			provideBuffer(segment.bufferId);
+			ring->segments.pop_front();
+			publishBuffers();
+		}
+
+		return len;
+	}
+
+	/**
+	 * Zero-copy receive: returns a view into the ring buffer the kernel received into.
+	 * The view stays valid until the next receive call on this transport.
+	*/
+	inline Chunk recvChunk(const size_t maxLen) const {
+		waitForData();
+
+		Segment& segment = ring->segments.front();
+		const uint32_t len = std::min<size_t>(maxLen, segment.length);
+		const Chunk chunk(bufferAddress(segment.bufferId) + segment.offset, len);
+		segment.offset += len;
+		segment.length -= len;
+
+		if(segment.length == 0) {
+			ring->deferredBufferId = segment.bufferId;
+			ring->segments.pop_front();
+		}
+
+		return chunk;
+	}
+
+private:
+	// ---- setup ----
+
+	inline void setupRing() const {
+		Ring& r = *ring;
+
+		io_uring_params params {};
+		r.fd = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+		if(r.fd < 0)
+			throw std::runtime_error("io_uring_setup failed: " + std::string(strerror(errno)));
+
+		r.sqEntries = params.sq_entries;
+		r.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		r.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+		const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+		if(singleMmap)
+			r.sqRingSize = r.cqRingSize = std::max(r.sqRingSize, r.cqRingSize);
+
+		r.sqRing = mapRing(r.sqRingSize, IORING_OFF_SQ_RING);
+		r.cqRing = singleMmap ? r.sqRing : mapRing(r.cqRingSize, IORING_OFF_CQ_RING);
+		r.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		r.sqes = reinterpret_cast<io_uring_sqe*>(mapRing(r.sqesSize, IORING_OFF_SQES));
+
+		r.sqHead  = reinterpret_cast<unsigned*>(r.sqRing + params.sq_off.head);
+		r.sqTail  = reinterpret_cast<unsigned*>(r.sqRing + params.sq_off.tail);
+		r.sqMask  = reinterpret_cast<unsigned*>(r.sqRing + params.sq_off.ring_mask);
+		r.sqArray = reinterpret_cast<unsigned*>(r.sqRing + params.sq_off.array);
+		r.cqHead  = reinterpret_cast<unsigned*>(r.cqRing + params.cq_off.head);
+		r.cqTail  = reinterpret_cast<unsigned*>(r.cqRing + params.cq_off.tail);
+		r.cqMask  = reinterpret_cast<unsigned*>(r.cqRing + params.cq_off.ring_mask);
+		r.cqes    = reinterpret_cast<io_uring_cqe*>(r.cqRing + params.cq_off.cqes);
+	}
+
+	inline uint8_t* mapRing(const size_t size, const off_t offset) const {
+		void *const ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, offset);
+		if(ptr == MAP_FAILED)
+			throw std::runtime_error("mmap of io_uring failed: " + std::string(strerror(errno)));
+		return reinterpret_cast<uint8_t*>(ptr);
+	}
+
+	inline void setupBufferRing() const {
+		Ring& r = *ring;
+
+		r.bufRingSize = NUM_BUFFERS * sizeof(io_uring_buf); // mmap -> page aligned, as required by the kernel
+		void *const bufRing = mmap(nullptr, r.bufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(bufRing == MAP_FAILED)
+			throw std::runtime_error("mmap of buffer ring failed: " + std::string(strerror(errno)));
+		r.bufRing = reinterpret_cast<io_uring_buf*>(bufRing);
+
+		void *const bufferMemory = mmap(nullptr, size_t(NUM_BUFFERS) * BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(bufferMemory == MAP_FAILED)
+			throw std::runtime_error("mmap of receive buffers failed: " + std::string(strerror(errno)));
+		r.bufferMemory = reinterpret_cast<uint8_t*>(bufferMemory);
+
+		io_uring_buf_reg reg {};
+		reg.ring_addr = reinterpret_cast<uint64_t>(r.bufRing);
+		reg.ring_entries = NUM_BUFFERS;
+		reg.bgid = BUFFER_GROUP;
+		if(syscall(__NR_io_uring_register, r.fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+			throw std::runtime_error("registering provided buffer ring failed: " + std::string(strerror(errno)));
+
+		for(uint16_t bufferId = 0; bufferId < NUM_BUFFERS; bufferId++)
+			provideBuffer(bufferId);
+		publishBuffers();
+	}
+
+
+	// ---- provided buffers ----
+
+	inline uint8_t* bufferAddress(const uint16_t bufferId) const {
+		return ring->bufferMemory + size_t(bufferId) * BUFFER_SIZE;
+	}
+
+	inline void provideBuffer(const uint16_t bufferId) const {
+		Ring& r = *ring;
+		io_uring_buf& buf = r.bufRing[r.bufRingTail & (NUM_BUFFERS - 1)];
+		buf.addr = reinterpret_cast<uint64_t>(bufferAddress(bufferId));
+		buf.len = BUFFER_SIZE;
+		buf.bid = bufferId;
+		r.bufRingTail++;
+	}
+
+	// make buffers added by provideBuffer() visible to the kernel
+	inline void publishBuffers() const {
+		__atomic_store_n(&ring->bufRing[0].resv, ring->bufRingTail, __ATOMIC_RELEASE); // ring tail overlays bufs[0].resv
+	}
+
+	inline void recycleDeferredBuffer() const {
+		if(ring->deferredBufferId < 0)
+			return;
+
+		provideBuffer(ring->deferredBufferId);
+		publishBuffers();
+		ring->deferredBufferId = -1;
+	}
+
+
+	// ---- submission / completion ----
+
+	inline io_uring_sqe* nextSqe() const {
+		Ring& r = *ring;
+		const unsigned tail = *r.sqTail;
+		if(tail - __atomic_load_n(r.sqHead, __ATOMIC_ACQUIRE) >= r.sqEntries)
+			submit(0); // queue full; hand everything to the kernel first
+
+		const unsigned index = tail & *r.sqMask;
+		io_uring_sqe *const sqe = &r.sqes[index];
+		memset(sqe, 0, sizeof(io_uring_sqe));
+		r.sqArray[index] = index;
+		__atomic_store_n(r.sqTail, tail + 1, __ATOMIC_RELEASE);
+		r.numUnsubmitted++;
+		return sqe;
+	}
+
+	inline void armRecv() const {
+		io_uring_sqe *const sqe = nextSqe();
+		sqe->opcode = IORING_OP_RECV;
+		sqe->fd = sock;
+		sqe->ioprio = IORING_RECV_MULTISHOT;
+		sqe->flags = IOSQE_BUFFER_SELECT;
+		sqe->buf_group = BUFFER_GROUP;
+		sqe->user_data = TAG_RECV;
+		ring->recvArmed = true;
+	}
+
+	inline void prepareSend() const {
+		Ring& r = *ring;
+		io_uring_sqe *const sqe = nextSqe();
+		sqe->opcode = IORING_OP_SEND;
+		sqe->fd = sock;
+		sqe->addr = reinterpret_cast<uint64_t>(r.sendInFlight.data() + r.sendInFlightOffset);
+		sqe->len = r.sendInFlight.size() - r.sendInFlightOffset;
+		sqe->msg_flags = MSG_NOSIGNAL;
+		sqe->user_data = TAG_SEND;
+	}
+
+	inline void submit(const unsigned minComplete) const {
+		Ring& r = *ring;
+		const unsigned flags = minComplete ? IORING_ENTER_GETEVENTS : 0;
+		while(syscall(__NR_io_uring_enter, r.fd, r.numUnsubmitted, minComplete, flags, nullptr, 0) < 0)
+			if(errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				throw std::runtime_error("io_uring_enter failed: " + std::string(strerror(errno)));
+		r.numUnsubmitted = 0;
+	}
+
+	inline void waitForCompletions() const {
+		submit(1);
+		reapCompletions();
+	}
+
+	inline void reapCompletions() const {
+		Ring& r = *ring;
+		unsigned head = *r.cqHead;
+		const unsigned tail = __atomic_load_n(r.cqTail, __ATOMIC_ACQUIRE);
+
+		bool buffersReturned = false;
+		for(; head != tail; head++) {
+			const io_uring_cqe& cqe = r.cqes[head & *r.cqMask];
+
+			if(cqe.user_data == TAG_RECV) {
+				if(cqe.res > 0) {
+					r.segments.push_back(Segment {
+						.bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT),
+						.offset = 0,
+						.length = static_cast<uint32_t>(cqe.res) });
+				} else {
+					if(cqe.flags & IORING_CQE_F_BUFFER) // no data, but a buffer was picked; give it back
+						provideBuffer(cqe.flags >> IORING_CQE_BUFFER_SHIFT), buffersReturned = true;
+
+					if(cqe.res == 0)
+						r.peerClosed = true;
+					else if(cqe.res != -ENOBUFS) // ENOBUFS: all buffers held by us; re-armed once some are consumed
+						r.recvError = -cqe.res;
+				}
+
+				if(!(cqe.flags & IORING_CQE_F_MORE))
+					r.recvArmed = false;
+			} else if(cqe.user_data == TAG_SEND) {
+				if(cqe.res < 0) {
+					r.sendError = -cqe.res;
+					r.sendBusy = false;
+				} else if((r.sendInFlightOffset += cqe.res) < r.sendInFlight.size()) {
+					prepareSend(); // short send; push the remainder
+				} else {
+					r.sendBusy = false;
+				}
+			}
+		}
+
+		__atomic_store_n(r.cqHead, head, __ATOMIC_RELEASE);
+
+		if(buffersReturned)
+			publishBuffers();
+
+		if(!r.sendBusy) // continue with whatever was queued in the meantime
+			flush();
+		else if(r.numUnsubmitted)
+			submit(0);
+	}
+
+	// block until at least one received segment is available
+	inline void waitForData() const {
+		recycleDeferredBuffer();
+		flush();
+
+		for(;;) {
+			reapCompletions();
+
+			if(!ring->segments.empty())
+				return;
+			if(ring->recvError)
+				throw std::runtime_error("recv() failed: " + std::string(strerror(ring->recvError)));
+			if(ring->peerClosed)
+				throw std::runtime_error("recv(): Connection closing...");
+
+			if(!ring->recvArmed)
+				armRecv();
+
+			waitForCompletions();
+		}
+	}
+};
\ No newline at end of file
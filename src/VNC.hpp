@@ -1,914 +1,2519 @@
-#pragma once
-
-
-#include <unordered_set>
-#include <algorithm>
-#include <cstdint>
-#include <vector>
-#include <array>
-#include <cmath>
-
-#include "Socket.hpp"
-#include "compression/deflate_decompress.h"
-#include "DES.hpp"
-
-
-// Client-to-Server-message types:
-// 0 -> setPixelFormat
-// 2 -> setEncodings
-// 3 -> framebufferUpdateRequest
-// 4 -> keyEvent
-// 5 -> pointerEvent
-// 6 -> clientCutText
-
-
-// Server-to-Client-message types:
-// 0 -> FramebufferUpdate
-// 1 -> SetColorMapEntries
-// 2 -> Bell
-// 3 -> ServerCutText
-
-
-/**
- * Partial implementation of RFB Protocol (https://datatracker.ietf.org/doc/html/rfc6143)
- * Tested Features:
- *  - 32-bit padded 24-bit color
- *  - Authentications: NONE and VNC
- *  - Encodings: RAW, COPYRECT, ZRLE
- *  - Pseudoencodings: Cursor Pseudoencoding (without saving cursor data; just to save bandwidth)
-*/
-class VNC {
-private:
-	struct PixelFormat {
-		uint8_t bits_per_pixel;
-		uint8_t depth;
-		uint8_t big_endian_flag;
-		uint8_t true_color_flag;
-		uint16_t red_max;
-		uint16_t green_max;
-		uint16_t blue_max;
-		uint8_t red_shift;
-		uint8_t green_shift;
-		uint8_t blue_shift;
-	};
-
-	struct ServerInit {
-		uint16_t fbWidth;
-		uint16_t fbHeight;
-		PixelFormat pixelFormat;
-		uint32_t nameLength;
-		std::string name;
-	};
-
-	struct RectHeader {
-		uint16_t pos_x;
-		uint16_t pos_y;
-		uint16_t width;
-		uint16_t height;
-		enum class EncodingType : int32_t {
-			RAW = 0,
-			COPYRECT = 1,
-			RRE = 2,
-			HEXTILE = 5,
-			TRLE = 15,
-			ZRLE = 16,
-			CURSOR_PSEUDOENCODING = -239,
-			DESKTOPSIZE_PSEUDOENCODING = -223,
-		} encoding_type;
-	};
-
-private:
-	Socket sock;
-
-	std::string name;
-
-	ServerInit serverInit;
-	uint16_t fb_width, fb_height;
-	uint8_t* pixelData;
-
-public:
-	inline VNC(const std::string& host, const uint16_t port):
-			sock(host, port) {
-
-		printf("socket connection succeeded\n");
-
-		// Choose RFP Version:
-		const std::string& serverRFPVersion = sock.recvString(12);
-		std::cout << "Server Version: " << serverRFPVersion << "\n";
-
-		const char* version = "RFB 003.008\n";
-		sock.send(version, 12);
-
-		// Choose Security Type:
-		const uint8_t numSecurityTypes = sock.recvU8(); // receive number of security types
-		std::cout << "Num security types: " << static_cast<int>(numSecurityTypes) << "\n";
-
-		std::unordered_set<uint8_t> securityTypes;
-		for(size_t i = 0; i < numSecurityTypes; i++)
-			securityTypes.insert(sock.recvU8());
-
-		for(const uint8_t& securityType : securityTypes)
-			std::cout << " - SecurityType <" << static_cast<int>(securityType) << "> received\n";
-
-		if(securityTypes.find(1) != securityTypes.end()) { // None (no authentication required)
-			std::cout << "Authentication: None\n";
-
-			sock.sendU8(1); // send security type 1 (None)
-		} else if(securityTypes.find(2) != securityTypes.end()) { // VNC Authentication (DES challenge)
-			std::cout << "Authentication: VNC\n";
-
-			// Ask for Password:
-			std::string password;
-			std::cout << "Please input Password: ";
-			std::cin >> password;
-			std::cout << "You chose: \"" << password << "\"\n";
-
-			sock.sendU8(2); // send security type 2 (VNC authentication)
-
-			// Authenticate using VNC challenge:
-			std::array<uint8_t, 16> vncChallenge;
-			sock.recvExactly(vncChallenge.data(), 16); // receive random 16-byte vnc-auth challenge
-
-			std::array<uint8_t, 16> vncChallengeEncrypted = desEncrypt(vncChallenge, password); // Encrypt vnc-auth challenge
-			sock.send(vncChallengeEncrypted.data(), 16); // reply to vnc-auth challenge
-			std::cout << "Sent encrypted challenge back to server...\n";
-		}
-
-		const uint32_t securityResult = sock.recvU32(); // get SecurityResult handshake
-		if(securityResult != 0)
-			throw std::runtime_error("Security Handshake failed!"); // TODO: catch and show reason sent by server
-		std::cout << "SecurityResult Handshake: PASSED\n";
-
-
-		// Exchange init messages:
-		sock.sendU8(1); // send ClientInit (shared: true -> allow sharing session with other clients)
-
-		const ServerInit serverInit = recvServerInit();
-		pixelData = new uint8_t[serverInit.fbWidth * serverInit.fbHeight * 4]; // TODO: correct bytes per pixel
-
-		fb_width = serverInit.fbWidth;
-		fb_height = serverInit.fbHeight;
-
-		if(serverInit.pixelFormat.true_color_flag == false)
-			throw std::runtime_error("Server does not support true_color. aborting.");
-
-		std::cout << "ServerInit:\n"
-			<< " - Width: " << serverInit.fbWidth << "  Height: " << serverInit.fbHeight << "  name: " << serverInit.name << "\n"
-			<< " - Pixel Format:\n"
-				<< "   - Bits per Pixel: " << (int)serverInit.pixelFormat.bits_per_pixel << "  depth: " << (int)serverInit.pixelFormat.depth << "\n"
-				<< "   - big_endian: " << std::boolalpha << (bool)serverInit.pixelFormat.big_endian_flag << "  true_color: " << (bool)serverInit.pixelFormat.true_color_flag << "\n"
-				<< "   - red_max: " << (int)serverInit.pixelFormat.red_max << "  green_max: " << (int)serverInit.pixelFormat.green_max << "  blue_max: " << (int)serverInit.pixelFormat.blue_max << "\n"
-				<< "   - red_shift: " << (int)serverInit.pixelFormat.red_shift << "  green_shift: " << (int)serverInit.pixelFormat.green_shift << "  blue_shift: " << (int)serverInit.pixelFormat.blue_shift << "\n";
-
-		// setPixelFormat not necessary, will use default server settings...
-
-		// setEncodings:
-		std::vector<int32_t> encodings;
-		encodings.push_back(0); // Raw
-		encodings.push_back(1); // CopyRect
-		// encodings.push_back(2); // RRE
-		// encodings.push_back(5); // Hextile
-		// encodings.push_back(15); // TRLE
-		encodings.push_back(16); // ZRLE
-		encodings.push_back(-239); // cursor pseudoencoding
-		// encodings.push_back(-223); // desktopsize pseudoencoding
-
-		sock.sendU8(2); // Type (= setEncodings)
-		sock.sendU8(0); // padding
-		sock.sendU16(encodings.size()); // numberOfEncodings: 1
-		for(const int32_t& enc : encodings)
-			sock.sendS32(enc);
-	}
-
-
-	// ---- Sending ----
-
-	inline void sendUpdateRequest(const size_t posX, const size_t posY, const size_t width, const size_t height, const bool incremental = true) const {
-		sock.sendPrimitive<uint8_t>(3); // MessageType (3 = FrameBufferUpdateRequest)
-		sock.sendPrimitive<uint8_t>(incremental);
-		sock.sendPrimitive<uint16_t>(htons(posX));
-		sock.sendPrimitive<uint16_t>(htons(posY));
-		sock.sendPrimitive<uint16_t>(htons(width));
-		sock.sendPrimitive<uint16_t>(htons(height));
-	}
-
-	inline void sendPointerEvent(const uint16_t posX, const uint16_t posY, const uint8_t buttonMask) const {
-		sock.sendPrimitive<uint8_t>(5); // MessageType (5 = PointerEvent)
-		sock.sendPrimitive<uint8_t>(buttonMask);
-		sock.sendPrimitive<uint16_t>(htons(posX));
-		sock.sendPrimitive<uint16_t>(htons(posY));
-	}
-
-	inline void sendKeyEvent(const bool downFlag, const uint32_t key) const {
-		sock.sendPrimitive<uint8_t>(4); // MessageType (4 = KeyEvent)
-		sock.sendPrimitive<uint8_t>(downFlag);
-		sock.sendPrimitive<uint16_t>(0); // padding
-		sock.sendPrimitive<uint32_t>(htonl(key));
-	}
-
-
-	// ---- Receiving ----
-
-	inline ServerInit recvServerInit() const {
-		ServerInit serverInit;
-		serverInit.fbWidth = ntohs(sock.recvPrimitive<uint16_t>());
-		serverInit.fbHeight = ntohs(sock.recvPrimitive<uint16_t>());
-		serverInit.pixelFormat = recvPixelFormat();
-		serverInit.nameLength = ntohl(sock.recvPrimitive<uint32_t>());
-		serverInit.name = sock.recvString(serverInit.nameLength);
-		return serverInit;
-	}
-
-	inline PixelFormat recvPixelFormat() const {
-		PixelFormat pixelFormat;
-		pixelFormat.bits_per_pixel  = sock.recvPrimitive<uint8_t>();
-		pixelFormat.depth           = sock.recvPrimitive<uint8_t>();
-		pixelFormat.big_endian_flag = sock.recvPrimitive<uint8_t>();
-		pixelFormat.true_color_flag = sock.recvPrimitive<uint8_t>();
-		pixelFormat.red_max   = ntohs(sock.recvPrimitive<uint16_t>());
-		pixelFormat.green_max = ntohs(sock.recvPrimitive<uint16_t>());
-		pixelFormat.blue_max  = ntohs(sock.recvPrimitive<uint16_t>());
-		pixelFormat.red_shift   = sock.recvPrimitive<uint8_t>();
-		pixelFormat.green_shift = sock.recvPrimitive<uint8_t>();
-		pixelFormat.blue_shift  = sock.recvPrimitive<uint8_t>();
-
-		for(size_t i = 0; i < 3; i++)
-			sock.recvPrimitive<uint8_t>(); // receive padding
-
-		return pixelFormat;
-	}
-
-	inline void recvUpdates() {
-		if(!sock.dataAvailable()) return;
-
-		enum class MessageType : uint8_t {
-			FRAMEBUFFER_UPDATE = 0,
-			SET_COLORMAP_ENTRIES = 1,
-			BELL = 2,
-			SERVER_CUT_TEXT = 3
-		} messageType;
-		sock.recvExactly(&messageType, 1); // receive FrameBufferUpdate
-
-		switch(messageType) {
-			case MessageType::FRAMEBUFFER_UPDATE: {
-				const uint16_t numRects = recvFrameBufferUpdate();
-
-				// std::cout << "Got FrameBufferUpdate\n";
-				// std::cout << " - Num Rectangles: " << numRects << "\n";
-
-				for(size_t i = 0; i < numRects; i++) {
-					const RectHeader& rectHeader = recvUpdateRectHeader();
-
-					// std::cout << "Rect:\n"
-					// 	<< "  pos_x: " << rectHeader.pos_x << " pos_y: " << rectHeader.pos_y << "\n"
-					// 	<< "  width: " << rectHeader.width << " height: " << rectHeader.height << "\n"
-					// 	<< "  encoding_type: " << static_cast<int>(rectHeader.encoding_type) << "\n";
-					
-					recvUpdateRect(rectHeader);
-				}
-			} break;
-
-			case MessageType::SET_COLORMAP_ENTRIES: {
-				throw std::runtime_error("Received SET_COLORMAP_ENTRIES. aborting");
-			} break;
-
-			case MessageType::BELL: {
-				std::cout << "<BELL>\n";
-			} break;
-
-			case MessageType::SERVER_CUT_TEXT: {
-				std::cout << "Received Clipboard \"" << recvServerClipboard() << "\"\n";
-			} break;
-
-			default:
-				throw std::runtime_error("Received update of non-zero type " + std::to_string(static_cast<uint8_t>(messageType)));
-		}
-	}
-
-	inline uint16_t recvFrameBufferUpdate() {
-		sock.recvPrimitive<uint8_t>(); // receive padding
-
-		const uint16_t numRectangles = ntohs(sock.recvPrimitive<uint16_t>());
-
-		return numRectangles;
-	}
-
-	inline RectHeader recvUpdateRectHeader() {
-		RectHeader rectHeader;
-		rectHeader.pos_x  = ntohs(sock.recvPrimitive<uint16_t>());
-		rectHeader.pos_y  = ntohs(sock.recvPrimitive<uint16_t>());
-		rectHeader.width  = ntohs(sock.recvPrimitive<uint16_t>());
-		rectHeader.height = ntohs(sock.recvPrimitive<uint16_t>());
-		rectHeader.encoding_type = static_cast<RectHeader::EncodingType>(ntohl(sock.recvPrimitive<int32_t>()));
-		return rectHeader;
-	}
-
-	inline void recvUpdateRect(const RectHeader& rectHeader) {
-		switch(rectHeader.encoding_type) {
-			case RectHeader::EncodingType::RAW:
-				recvUpdateRectRAW(rectHeader);
-				break;
-			case RectHeader::EncodingType::COPYRECT:
-				recvUpdateRectCOPYRECT(rectHeader);
-				break;
-			case RectHeader::EncodingType::RRE:
-				throw std::runtime_error("Received UpdateRect message of encoding type RRE");
-				break;
-			case RectHeader::EncodingType::HEXTILE:
-				throw std::runtime_error("Received UpdateRect message of encoding type HEXTILE");
-				break;
-			case RectHeader::EncodingType::TRLE:
-				throw std::runtime_error("Received UpdateRect message of encoding type TRLE");
-				// std::cout << "Received UpdateRect message of encoding type TRLE\n";
-				// recvUpdateRectTRLE(rectHeader);
-				break;
-			case RectHeader::EncodingType::ZRLE:
-				// throw std::runtime_error("Received UpdateRect message of encoding type ZRLE");
-				// std::cout << "Received UpdateRect message of encoding type ZRLE\n";
-				recvUpdateRectZRLE(rectHeader);
-				break;
-			case RectHeader::EncodingType::CURSOR_PSEUDOENCODING:
-				std::cout << "Received UpdateRect message of encoding type CURSOR_PSEUDOENCODING\n";
-				for(size_t i = 0; i < rectHeader.width * rectHeader.height * 4; i++) sock.recvU8(); // read cursor-pixels
-				for(size_t i = 0; i < (rectHeader.width + 7) / 8 * rectHeader.height; i++) sock.recvU8(); // read cursor-bitmask
-				break;
-			case RectHeader::EncodingType::DESKTOPSIZE_PSEUDOENCODING:
-				throw std::runtime_error("Received UpdateRect message of encoding type DESKTOPSIZE_PSEUDOENCODING");
-				break;
-			default:
-				throw std::runtime_error("Error: unknown update-rect encoding type " + std::to_string(static_cast<int>(rectHeader.encoding_type)));
-				break;
-		}
-	}
-
-	inline std::string recvServerClipboard() const {
-		for(size_t i = 0; i < 3; i++)
-			sock.recvPrimitive<uint8_t>(); // receive padding
-	
-		const uint32_t clipboardLength = ntohl(sock.recvPrimitive<uint32_t>());
-
-		return sock.recvString(clipboardLength);
-	}
-
-	// ---- updaterect type implementations ----
-
-	inline void recvUpdateRectRAW(const RectHeader& rectHeader) {
-		const size_t BYTES_PER_PIXEL = 4;
-
-		// const size_t rect_size_bytes = rectHeader.width * rectHeader.height * (pixelFormat.bits_per_pixel / 8);
-		const size_t rect_size_bytes = rectHeader.width * rectHeader.height * 4; // TODO: correct pixel byte size
-		std::vector<uint8_t> updateRect(rect_size_bytes);
-
-		sock.recvExactly(updateRect.data(), rect_size_bytes); // read raw framebuffer overwrite
-
-		for(size_t y = 0; y < rectHeader.height; y++) {
-			for(size_t x = 0; x < rectHeader.width; x++) {
-				const size_t dstX = rectHeader.pos_x + x;
-				const size_t dstY = rectHeader.pos_y + y;
-				const size_t ind_dst = (dstY * fb_width + dstX) * 4;
-
-				const size_t ind_update = (y * rectHeader.width + x) * 4;
-
-				for(size_t i = 0; i < BYTES_PER_PIXEL; i++)
-					pixelData[ind_dst + i] = updateRect[ind_update + i];
-			}
-		}
-	}
-
-	inline void recvUpdateRectCOPYRECT(const RectHeader& rectHeader) {
-		const size_t BYTES_PER_PIXEL = 4;
-
-		const uint16_t srcX0 = sock.recvU16();
-		const uint16_t srcY0 = sock.recvU16();
-
-		std::vector<uint8_t> data(rectHeader.width * rectHeader.height * 4);
-		for(size_t y = 0; y < rectHeader.height; y++) {
-			for(size_t x = 0; x < rectHeader.width; x++) {
-				const size_t srcX = srcX0 + x;
-				const size_t srcY = srcY0 + y;
-				const size_t ind_src = (srcY * fb_width + srcX) * 4;
-
-				const size_t ind_data = (y * rectHeader.width + x) * 4;
-
-				for(size_t i = 0; i < BYTES_PER_PIXEL; i++)
-					data[ind_data + i] = pixelData[ind_src + i];
-			}
-		}
-
-		for(size_t y = 0; y < rectHeader.height; y++) {
-			for(size_t x = 0; x < rectHeader.width; x++) {
-				const size_t dstX = rectHeader.pos_x + x;
-				const size_t dstY = rectHeader.pos_y + y;
-				const size_t ind_dst = (dstY * fb_width + dstX) * 4;
-
-				const size_t ind_data = (y * rectHeader.width + x) * 4;
-
-				for(size_t i = 0; i < BYTES_PER_PIXEL; i++)
-					pixelData[ind_dst + i] = data[ind_data + i];
-			}
-		}
-	}
-
-	inline void recvUpdateRectTRLE(const RectHeader& rectHeader) { // tiled run-length encoding
-	}
-	/*
-	inline void recvUpdateRectTRLE(const RectHeader& rectHeader) { // tiled run-length encoding
-		const size_t numTilesX = rectHeader.width / 16 + !!(rectHeader.width % 16);
-		const size_t numTilesY = rectHeader.height / 16 + !!(rectHeader.height % 16);
-
-		struct {
-			size_t paletteSize;
-			uint32_t palette[16];
-		} packedPallette;
-
-		struct {
-			size_t paletteSize;
-			uint32_t palette[127];
-		} rlePallette;
-
-		for(size_t tileY = 0; tileY < numTilesY; tileY++) {
-			for(size_t tileX = 0; tileX < numTilesX; tileX++) {
-				const uint8_t subEncoding = sock.recvU8();
-
-				const uint8_t width  = std::min<uint8_t>(rectHeader.width  - tileX * 16, 16);
-				const uint8_t height = std::min<uint8_t>(rectHeader.height - tileY * 16, 16);
-
-				switch(subEncoding) {
-				case 0: { // raw
-					for(size_t localY = 0; localY < height; localY++) {
-						for(size_t localX = 0; localX < width; localX++) {
-							const size_t absX = tileX * 16 + localX;
-							const size_t absY = tileY * 16 + localY;
-
-							uint32_t col = 0;
-							col |= sock.recvU8() << 16; // red
-							col |= sock.recvU8() <<  8; // green
-							col |= sock.recvU8() <<  0; // blue
-
-							reinterpret_cast<uint32_t*>(pixelData)[absY * fb_width + absX] = col;
-						}
-					}
-				} break;
-				
-				case 1: { // solid color
-				}
-				
-				// packed palette
-				case 2:
-				case 3:
-				case 4:
-				case 5:
-				case 6:
-				case 7:
-				case 8:
-				case 9:
-				case 10:
-				case 11:
-				case 12:
-				case 13:
-				case 14:
-				case 15:
-				case 16: {
-					packedPallette.paletteSize = subEncoding;
-
-					// receive palette:
-					for(size_t i = 0; i < packedPallette.paletteSize; i++) {
-						packedPallette.palette[i] = 0;
-						packedPallette.palette[i] |= sock.recvU8() << 16; // red
-						packedPallette.palette[i] |= sock.recvU8() <<  8; // green
-						packedPallette.palette[i] |= sock.recvU8() <<  0; // blue
-					}
-				
-				case 127: // reuse palette of the previous tile
-					const size_t bitsPerPixel =
-						(packedPallette.paletteSize == 2)                                    ? 1 : // paletteSize == 2
-						(packedPallette.paletteSize == 3 || packedPallette.paletteSize == 4) ? 2 : // 3 <= paletteSize <= 4
-						                                                                       4;  // 5 <= paletteSize <= 16
-					const size_t pixelsPerByte = 8 / bitsPerPixel;
-
-					const size_t bytesX = (width + pixelsPerByte - 1) / pixelsPerByte;
-						// (paletteSize == 2)                     ? ((width + 7) / 8) : // paletteSize == 2
-						// (paletteSize == 3 || paletteSize == 4) ? ((width + 3) / 4) : // 3 <= paletteSize <= 4
-						//                                          ((width + 1) / 2);  // 5 <= paletteSize <= 16
-					
-					// receive packed pixels:
-					for(size_t localY = 0; localY < height; localY++) {
-						for(size_t byteX = 0; byteX < bytesX; byteX++) {
-							const uint8_t byte = sock.recvU8();
-							const size_t pixelsInThisByte = std::min<size_t>(width - (byteX * pixelsPerByte), pixelsPerByte);
-
-							for(size_t pixelSubIndex = 0; pixelSubIndex < pixelsInThisByte; pixelSubIndex++) { // iterate over all pixels packed into the current byte
-								const uint8_t bitOff = (pixelsInThisByte - 1 - pixelSubIndex) * bitsPerPixel; // bits are packed left -> right : msb -> lsb
-								const uint8_t mask = (0x01 << bitsPerPixel) - 1;
-								const uint8_t pixel = (byte >> bitOff) & mask; // extract index into palette
-
-								const size_t absX = (tileX) * 16 + (byteX * pixelsPerByte + pixelSubIndex);
-								const size_t absY = (tileY) * 16 + localY;
-
-								reinterpret_cast<uint32_t*>(pixelData)[absY * fb_width + absX] = packedPallette.palette[pixel];
-							}
-						}
-					}
-				} break;
-
-				case 128: { // plain RLE (run-length encoding)
-					const auto getRunLength = [&]() -> size_t {
-							size_t runLength = 0;
-							uint8_t byte = 0;
-							do {
-								byte = sock.recvU8();
-								runLength += byte;
-							} while(byte == 255);
-							return runLength;
-						};
-					
-					const auto getCPixel = [&]() -> uint32_t {
-							uint32_t color = 0;
-							color |= sock.recvU8() << 16; // red
-							color |= sock.recvU8() <<  8; // green
-							color |= sock.recvU8() <<  0; // blue
-							return color;
-						};
-					
-					size_t runLength = 1;
-					uint32_t pixelValue;
-
-					for(size_t localY = 0; localY < height; localY++) {
-						for(size_t localX = 0; localX < width; localX++) {
-							const size_t absX = tileX * 16 + localX;
-							const size_t absY = tileY * 16 + localY;
-
-							if(--runLength == 0) {
-								pixelValue = getCPixel();
-								runLength = getRunLength();
-							}
-
-							reinterpret_cast<uint32_t*>(pixelData)[absY * fb_width + absX] = pixelValue;
-						}
-					}
-				} break;
-
-				//  Palette RLE
-				case 130: case 131: case 132: case 133: case 134: case 135: case 136: case 137: case 138: case 139:
-				case 140: case 141: case 142: case 143: case 144: case 145: case 146: case 147: case 148: case 149:
-				case 150: case 151: case 152: case 153: case 154: case 155: case 156: case 157: case 158: case 159:
-				case 160: case 161: case 162: case 163: case 164: case 165: case 166: case 167: case 168: case 169:
-				case 170: case 171: case 172: case 173: case 174: case 175: case 176: case 177: case 178: case 179:
-				case 180: case 181: case 182: case 183: case 184: case 185: case 186: case 187: case 188: case 189:
-				case 190: case 191: case 192: case 193: case 194: case 195: case 196: case 197: case 198: case 199:
-				case 200: case 201: case 202: case 203: case 204: case 205: case 206: case 207: case 208: case 209:
-				case 210: case 211: case 212: case 213: case 214: case 215: case 216: case 217: case 218: case 219:
-				case 220: case 221: case 222: case 223: case 224: case 225: case 226: case 227: case 228: case 229:
-				case 230: case 231: case 232: case 233: case 234: case 235: case 236: case 237: case 238: case 239:
-				case 240: case 241: case 242: case 243: case 244: case 245: case 246: case 247: case 248: case 249:
-				case 250: case 251: case 252: case 253: case 254: case 255: {
-					rlePallette.paletteSize = subEncoding - 128;
-
-					for(size_t i = 0; i < rlePallette.paletteSize; i++) {
-						rlePallette.palette[i] = 0;
-						rlePallette.palette[i] |= sock.recvU8() << 16; // red
-						rlePallette.palette[i] |= sock.recvU8() <<  8; // green
-						rlePallette.palette[i] |= sock.recvU8() <<  0; // blue
-					}
-
-				case 129: // Palette RLE using previous palette
-					const auto getRunLength = [&]() -> size_t {
-							size_t runLength = 0;
-							uint8_t byte = 0;
-							do {
-								byte = sock.recvU8();
-								runLength += byte;
-							} while(byte == 255);
-							return runLength;
-						};
-
-					size_t runLength = 1;
-					uint32_t paletteIndex;
-
-					for(size_t localY = 0; localY < height; localY++) {
-						for(size_t localX = 0; localX < width; localX++) {
-							const size_t absX = tileX * 16 + localX;
-							const size_t absY = tileY * 16 + localY;
-
-							if(--runLength == 0) {
-								const uint8_t rawIndex = sock.recvU8();
-
-								paletteIndex = rawIndex & 0x7F;
-								runLength = (rawIndex & 0x80) ? getRunLength() : 1;
-							}
-
-							reinterpret_cast<uint32_t*>(pixelData)[absY * fb_width + absX] = rlePallette.palette[paletteIndex];
-						}
-					}
-				} break;
-				}
-			}
-		}
-	}
-	*/
-
-
-	bool firstTime = true; // TODO: refactor
-	inline void recvUpdateRectZRLE(const RectHeader& rectHeader) { // tiled run-length encoding
-		uint32_t zlibLength = sock.recvU32();
-
-		if(firstTime) { // skip zlib header
-			sock.recvU16();
-			zlibLength -= 2;
-		}
-		firstTime = false;
-
-		// std::cout << "Zlib length: " << zlibLength << "\n"; 
-		// std::cout << "Representing " << rectHeader.width << " * " << rectHeader.height << " pixels\n";
-
-		// ----------------
-		// static std::vector<uint8_t> zlibData;
-		// const size_t zlibLengthPrev = zlibData.size();
-		// zlibData.resize(zlibLengthPrev + zlibLength);
-		// sock.recvExactly(zlibData.data() + zlibLengthPrev, zlibLength);
-		// ----------------
-
-
-		// ----------------
-		std::vector<uint8_t> zlibData(zlibLength);
-		sock.recvExactly(zlibData.data(), zlibLength);
-		// ----------------
-
-		// std::cout << "Zlib data received successfully\n";
-
-
-
-		static std::vector<uint8_t> prevData(32768); // store some decoded data for decoding LZ77 backreferences in future DEFLATE blocks
-		std::vector<uint8_t> rawData = prevData; // copy old data for decoding LZ77 backreferences
-
-		// std::vector<uint8_t> currentZlibData(zlibData.begin() + zlibLengthPrev, zlibData.end());
-		// const Bitstream stream(currentZlibData);
-		const Bitstream stream(zlibData);
-		BitstreamReader streamReader(stream);
-		// try {
-		// 	zlib::decompress(streamReader, rawData);
-
-		// std::vector<uint8_t> junkData;
-		// while(streamReader.numBytesRead < zlibLengthPrev)
-		// 	deflate::decompressBlock(streamReader, junkData);
-		// std::cout << "Decoded previous data. prevLength: " << zlibLengthPrev << "  decodedLength: " << streamReader.numBytesRead << "\n";
-
-		while(!streamReader.isEmpty())
-			deflate::decompressBlock(streamReader, rawData);
-
-		// std::cout << "zlibLength: " << zlibLength << "  bytesRead: " << streamReader.numBytesRead << "  bitsRead: " << (int)streamReader.numBitsRead << "\n";
-		// } catch(const std::exception& e) {
-		// 	std::cout << "decompress threw: " << e.what() << "\n";
-		// }
-
-		// static size_t usedBytes = 0;
-		// const size_t usedBytesBefore = usedBytes;
-		// usedBytes += rawData.size() - usedBytes;
-
-		// std::cout << "Decompressed successfully. Length: " << rawData.size() << "\n";
-
-		// size_t dataInd = 0;
-		size_t dataInd = 0 + prevData.size();
-		// size_t dataInd = 0 + usedBytesBefore;
-
-		const auto recvU8 =
-			[&]() -> uint8_t  {
-				if(dataInd >= rawData.size())
-					throw std::runtime_error("Out of uncompressed zlib data!");
-				const uint8_t val = rawData[dataInd]; dataInd++; return val;
-			};
-		
-		constexpr size_t TILE_SIZE = 64;
-		const size_t numTilesX = rectHeader.width / TILE_SIZE + !!(rectHeader.width % TILE_SIZE);
-		const size_t numTilesY = rectHeader.height / TILE_SIZE + !!(rectHeader.height % TILE_SIZE);
-
-		struct {
-			size_t paletteSize;
-			uint32_t palette[16];
-		} packedPallette;
-
-		struct {
-			size_t paletteSize;
-			uint32_t palette[127];
-		} rlePallette;
-
-		for(size_t tileY = 0; tileY < numTilesY; tileY++) {
-			for(size_t tileX = 0; tileX < numTilesX; tileX++) {
-				const uint8_t subEncoding = recvU8();
-
-				const size_t width  = std::min<size_t>(rectHeader.width  - tileX * TILE_SIZE, TILE_SIZE);
-				const size_t height = std::min<size_t>(rectHeader.height - tileY * TILE_SIZE, TILE_SIZE);
-
-				switch(subEncoding) {
-				case 0: { // raw
-					for(size_t localY = 0; localY < height; localY++) {
-						for(size_t localX = 0; localX < width; localX++) {
-							const size_t absX = rectHeader.pos_x + tileX * TILE_SIZE + localX;
-							const size_t absY = rectHeader.pos_y + tileY * TILE_SIZE + localY;
-
-							uint32_t col = 0;
-							col |= recvU8() <<  0; // blue
-							col |= recvU8() <<  8; // green
-							col |= recvU8() << 16; // red
-
-							reinterpret_cast<uint32_t*>(pixelData)[absY * fb_width + absX] = col;
-						}
-					}
-				} break;
-				
-				case 1: { // solid color
-					// std::cout << " - Solid color\n";
-					
-					uint32_t col = 0;
-					col |= recvU8() <<  0; // blue
-					col |= recvU8() <<  8; // green
-					col |= recvU8() << 16; // red
-
-					for(size_t localY = 0; localY < height; localY++) {
-						for(size_t localX = 0; localX < width; localX++) {
-							const size_t absX = rectHeader.pos_x + tileX * TILE_SIZE + localX;
-							const size_t absY = rectHeader.pos_y + tileY * TILE_SIZE + localY;
-
-							reinterpret_cast<uint32_t*>(pixelData)[absY * fb_width + absX] = col;
-						}
-					}
-				} break;
-				
-				// packed palette
-				case 2:
-				case 3:
-				case 4:
-				case 5:
-				case 6:
-				case 7:
-				case 8:
-				case 9:
-				case 10:
-				case 11:
-				case 12:
-				case 13:
-				case 14:
-				case 15:
-				case 16: {
-					// std::cout << " - Packed palette\n";
-					packedPallette.paletteSize = subEncoding;
-
-					// receive palette:
-					for(size_t i = 0; i < packedPallette.paletteSize; i++) {
-						packedPallette.palette[i] = 0;
-						packedPallette.palette[i] |= recvU8() <<  0; // blue
-						packedPallette.palette[i] |= recvU8() <<  8; // green
-						packedPallette.palette[i] |= recvU8() << 16; // red
-					}
-				
-				// case 127: // reuse palette of the previous tile (not valid for ZRLE)
-					const size_t bitsPerPixel =
-						(packedPallette.paletteSize == 2)                                    ? 1 : // paletteSize == 2
-						(packedPallette.paletteSize == 3 || packedPallette.paletteSize == 4) ? 2 : // 3 <= paletteSize <= 4
-						                                                                       4;  // 5 <= paletteSize <= 16
-					const size_t pixelsPerByte = 8 / bitsPerPixel;
-
-					const size_t bytesX = (width + pixelsPerByte - 1) / pixelsPerByte;
-					
-					// receive packed pixels:
-					for(size_t localY = 0; localY < height; localY++) {
-						for(size_t byteX = 0; byteX < bytesX; byteX++) {
-							const uint8_t byte = recvU8();
-							const size_t pixelsInThisByte = std::min<size_t>(width - (byteX * pixelsPerByte), pixelsPerByte);
-
-							for(size_t pixelSubIndex = 0; pixelSubIndex < pixelsInThisByte; pixelSubIndex++) { // iterate over all pixels packed into the current byte
-								const uint8_t bitOff = (pixelsInThisByte - 1 - pixelSubIndex) * bitsPerPixel; // bits are packed left -> right : msb -> lsb
-								const uint8_t mask = (0x01 << bitsPerPixel) - 1;
-								const uint8_t pixel = (byte >> bitOff) & mask; // extract index into palette
-
-								const size_t absX = rectHeader.pos_x + tileX * TILE_SIZE + (byteX * pixelsPerByte + pixelSubIndex);
-								const size_t absY = rectHeader.pos_y + tileY * TILE_SIZE + localY;
-
-								reinterpret_cast<uint32_t*>(pixelData)[absY * fb_width + absX] = packedPallette.palette[pixel];
-							}
-						}
-					}
-				} break;
-
-				case 128: { // plain RLE (run-length encoding)
-					// std::cout << " - Plain RLE\n";
-					const auto getRunLength = [&]() -> size_t {
-							size_t runLength = 0;
-							uint8_t byte = 0;
-							do {
-								byte = recvU8();
-								runLength += byte;
-							} while(byte == 255);
-							return runLength + 1;
-						};
-
-					const auto getCPixel = [&]() -> uint32_t {
-							uint32_t color = 0;
-							color |= recvU8() <<  0; // blue
-							color |= recvU8() <<  8; // green
-							color |= recvU8() << 16; // red
-							return color;
-						};
-
-					size_t runLength = 0;
-					uint32_t pixelValue;
-
-					for(size_t localY = 0; localY < height; localY++) {
-						for(size_t localX = 0; localX < width; localX++) {
-							const size_t absX = rectHeader.pos_x + tileX * TILE_SIZE + localX;
-							const size_t absY = rectHeader.pos_y + tileY * TILE_SIZE + localY;
-
-							if(runLength == 0) {
-								pixelValue = getCPixel();
-								runLength = getRunLength();
-							}
-
-							reinterpret_cast<uint32_t*>(pixelData)[absY * fb_width + absX] = pixelValue;
-
-							runLength--;
-						}
-					}
-				} break;
-
-				//  Palette RLE
-				case 130: case 131: case 132: case 133: case 134: case 135: case 136: case 137: case 138: case 139:
-				case 140: case 141: case 142: case 143: case 144: case 145: case 146: case 147: case 148: case 149:
-				case 150: case 151: case 152: case 153: case 154: case 155: case 156: case 157: case 158: case 159:
-				case 160: case 161: case 162: case 163: case 164: case 165: case 166: case 167: case 168: case 169:
-				case 170: case 171: case 172: case 173: case 174: case 175: case 176: case 177: case 178: case 179:
-				case 180: case 181: case 182: case 183: case 184: case 185: case 186: case 187: case 188: case 189:
-				case 190: case 191: case 192: case 193: case 194: case 195: case 196: case 197: case 198: case 199:
-				case 200: case 201: case 202: case 203: case 204: case 205: case 206: case 207: case 208: case 209:
-				case 210: case 211: case 212: case 213: case 214: case 215: case 216: case 217: case 218: case 219:
-				case 220: case 221: case 222: case 223: case 224: case 225: case 226: case 227: case 228: case 229:
-				case 230: case 231: case 232: case 233: case 234: case 235: case 236: case 237: case 238: case 239:
-				case 240: case 241: case 242: case 243: case 244: case 245: case 246: case 247: case 248: case 249:
-				case 250: case 251: case 252: case 253: case 254: case 255: {
-					// std::cout << " - Palette RLE\n";
-					rlePallette.paletteSize = subEncoding - 128;
-
-					for(size_t i = 0; i < rlePallette.paletteSize; i++) {
-						rlePallette.palette[i] = 0;
-						rlePallette.palette[i] |= recvU8() <<  0; // blue
-						rlePallette.palette[i] |= recvU8() <<  8; // green
-						rlePallette.palette[i] |= recvU8() << 16; // red
-					}
-
-				// case 129: // Palette RLE using previous palette (not valid for ZRLE)
-					const auto getRunLength = [&]() -> size_t {
-							size_t runLength = 0;
-							uint8_t byte = 0;
-							do {
-								byte = recvU8();
-								runLength += byte;
-							} while(byte == 255);
-							return runLength + 1;
-						};
-
-					size_t runLength = 0;
-					uint8_t paletteIndex;
-
-					for(size_t localY = 0; localY < height; localY++) {
-						for(size_t localX = 0; localX < width; localX++) {
-							const size_t absX = rectHeader.pos_x + tileX * TILE_SIZE + localX;
-							const size_t absY = rectHeader.pos_y + tileY * TILE_SIZE + localY;
-
-							if(runLength == 0) {
-								const uint8_t rawIndex = recvU8();
-
-								paletteIndex = rawIndex & 0x7F;
-								runLength = 1;
-
-								if(rawIndex & 0x80)
-									runLength = getRunLength();
-							}
-
-							reinterpret_cast<uint32_t*>(pixelData)[absY * fb_width + absX] = rlePallette.palette[paletteIndex];
-
-							runLength--;
-						}
-					}
-				} break;
-				}
-			}
-		}
-
-		// store some decoded data for decoding LZ77 backreferences in future DEFLATE blocks
-		if(rawData.size() >= prevData.size()) {
-			memcpy(prevData.data(), rawData.data() + rawData.size() - prevData.size(), prevData.size());
-		} else {
-			memcpy(prevData.data() + prevData.size() - rawData.size(), rawData.data(), rawData.size());
-		}
-	}
-
-
-	// ---- utilities ----
-
-	inline void close() const {
-		sock.close();
-	}
-
-	inline uint16_t width() const { return fb_width; }
-	inline uint16_t height() const { return fb_height; }
-	inline uint8_t* pixel_data() const { return pixelData; }
-};
\ No newline at end of file
+#pragma once
+
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <utility>
+#include <string>
+#include <vector>
+#include <array>
+#include <functional>
+#include <deque>
+#include <cmath>
+#include <type_traits>
+
+#include "timing.hpp"
+#include "Socket.hpp"
+#include "MemoryTransport.hpp"
+#include "ZlibStream.hpp"
+#include "PixelFormats.hpp"
+#include "jpeg/jpeg_decode.h"
+#include "Zywrle.hpp"
+#include "Cursor.hpp"
+#include "DES.hpp"
+
+
+// Client-to-Server-message types:
+// 0 -> setPixelFormat
+// 2 -> setEncodings
+// 3 -> framebufferUpdateRequest
+// 4 -> keyEvent
+// 5 -> pointerEvent
+// 6 -> clientCutText
+// 150 -> enableContinuousUpdates
+// 248 -> fence
+
+
+// Server-to-Client-message types:
+// 0 -> FramebufferUpdate
+// 1 -> SetColorMapEntries
+// 2 -> Bell
+// 3 -> ServerCutText
+// 150 -> EndOfContinuousUpdates
+// 248 -> Fence
+
+
+/**
+ * Partial implementation of RFB Protocol (https://datatracker.ietf.org/doc/html/rfc6143)
+ * Tested Features:
+ *  - 32-bit padded 24-bit color; 8-bit colour map (the framebuffer then holds indices into colorMap());
+ *    SetPixelFormat: RGB565, BGR233 and packed 24-bit on the wire, expanded to 32-bit in the framebuffer (see setPixelFormat())
+ *  - Authentications: NONE and VNC
+ *  - Encodings: RAW, COPYRECT, Zlib, ZRLE, ZYWRLE, Tight (including JPEG)
+ *  - Pseudoencodings: Cursor Pseudoencoding (shapes cached by hash, composited locally: see cursor()), DesktopSize, ExtendedDesktopSize, LastRect, ContinuousUpdates, Fence
+ * Transport is any ByteStream transport (Socket, UringSocket, MemoryTransport, MappedFileTransport, PipeTransport);
+ * its constructor arguments are forwarded by the BasicVNC constructor.
+ * Clock provides now() (ticks) and frequency() (ticks per second) for RTT, pacing, fences and UpdateBudget; PerformanceCounter by default.
+ * A Clock that is constructible from the transport gets constructed from it (e.g. LinkTime, the clock of an EmulatedLink).
+*/
+template<typename Transport, typename Clock = PerformanceCounter>
+class BasicVNC {
+private:
+	struct PixelFormat {
+		uint8_t bits_per_pixel;
+		uint8_t depth;
+		uint8_t big_endian_flag;
+		uint8_t true_color_flag;
+		uint16_t red_max;
+		uint16_t green_max;
+		uint16_t blue_max;
+		uint8_t red_shift;
+		uint8_t green_shift;
+		uint8_t blue_shift;
+	};
+
+	struct ServerInit {
+		uint16_t fbWidth;
+		uint16_t fbHeight;
+		PixelFormat pixelFormat;
+		uint32_t nameLength;
+		std::string name;
+	};
+
+	struct RectHeader {
+		uint16_t pos_x;
+		uint16_t pos_y;
+		uint16_t width;
+		uint16_t height;
+		enum class EncodingType : int32_t {
+			RAW = 0,
+			COPYRECT = 1,
+			RRE = 2,
+			CORRE = 4,
+			HEXTILE = 5,
+			ZLIB = 6,
+			TIGHT = 7,
+			TRLE = 15,
+			ZRLE = 16,
+			ZYWRLE = 17,
+			CURSOR_PSEUDOENCODING = -239,
+			DESKTOPSIZE_PSEUDOENCODING = -223,
+			LASTRECT_PSEUDOENCODING = -224,
+			EXTENDED_DESKTOPSIZE_PSEUDOENCODING = -308,
+			FENCE_PSEUDOENCODING = -312, // only announced in SetEncodings
+			CONTINUOUS_UPDATES_PSEUDOENCODING = -313, // only announced in SetEncodings
+			COMPRESS_LEVEL_0 = -256, // -256 .. -247, only announced in SetEncodings
+			QUALITY_LEVEL_0 = -32, // -32 .. -23, only announced in SetEncodings
+		} encoding_type;
+	};
+
+public:
+	// one monitor of the remote desktop (ExtendedDesktopSize)
+	struct Screen {
+		uint32_t id;
+		uint16_t pos_x;
+		uint16_t pos_y;
+		uint16_t width;
+		uint16_t height;
+		uint32_t flags;
+	};
+
+	// limits how long a single recvUpdates() call may keep processing queued messages
+	struct UpdateBudget {
+		double maxSeconds = 0.008;
+		size_t maxBytes = 16 * 1024 * 1024;
+	};
+
+	// what a recvUpdates() call has processed
+	struct UpdateSummary {
+		size_t numMessages = 0;
+		size_t numFramebufferUpdates = 0;
+		size_t numRects = 0;
+		size_t numBells = 0;
+		size_t bytesReceived = 0;
+		std::vector<std::string> cutTexts; // ServerCutText messages in order of arrival
+		bool budgetExhausted = false; // stopped while more data was pending
+		bool framebufferResized = false; // the whole (new) framebuffer is marked dirty then
+		bool cursorChanged = false; // new shape (or hidden): see cursor()
+		bool colorMapChanged = false; // the whole framebuffer is marked dirty then (its indices changed meaning)
+
+		// bounding box of all framebuffer changes (empty if dirtyX0 >= dirtyX1)
+		uint32_t dirtyX0 = UINT32_MAX, dirtyY0 = UINT32_MAX;
+		uint32_t dirtyX1 = 0, dirtyY1 = 0;
+
+		inline bool framebufferChanged() const { return dirtyX0 < dirtyX1 && dirtyY0 < dirtyY1; }
+	};
+
+private:
+	Transport sock;
+	Clock clock; // (initialized after sock)
+
+	std::string name;
+
+	ServerInit serverInit;
+	uint16_t fb_width, fb_height;
+	std::vector<uint8_t> pixelData; // keeps its capacity across resizes
+	WireFormat wireFormat = WireFormat::BGRX32; // of the pixels currently received; INDEXED8: indices into colorMapLUT
+	WireFormat targetFormat = WireFormat::BGRX32; // of the latest setPixelFormat()
+	WireFormat sentFormat = WireFormat::BGRX32; // of the latest SetPixelFormat message
+	// the server applies SetPixelFormat from its next update on, so it is only sent while no update is outstanding:
+	enum class FormatSwitch : uint8_t {
+		NONE,
+		UNSENT, // targetFormat differs from wireFormat
+		AT_NEXT_UPDATE // sent; the next FramebufferUpdate switches to sentFormat
+	} formatSwitch = FormatSwitch::NONE;
+	std::array<uint32_t, 256> colorMapLUT {}; // blue | green << 8 | red << 16, from SetColorMapEntries
+	size_t colorMapGeneration = 0; // incremented on every SetColorMapEntries
+	size_t framebufferGeneration = 0; // incremented on every resize
+	std::function<void(uint16_t width, uint16_t height)> resizeCallback;
+	std::vector<Screen> screenLayout; // from ExtendedDesktopSize
+
+public:
+	// measured (or, until the encoding was used, assumed) cost of an encoding
+	struct EncodingEstimate {
+		double bytesPerPixel;
+		double secondsPerPixel; // decode time
+		bool measured;
+	};
+
+private:
+	// adaptive encoding selection:
+	struct EncodingStats {
+		size_t bytes = 0;
+		size_t pixels = 0;
+		size_t ticks = 0;
+	};
+
+	static constexpr double EVALUATION_INTERVAL = 1.; // seconds
+	static constexpr size_t MIN_SAMPLE_PIXELS = 64 * 64; // per evaluation, for updating an estimate
+	static constexpr size_t DELIVERY_RATE_MIN_BYTES = 64 * 1024;
+	static constexpr size_t DELIVERY_RATE_HISTORY = 10; // evaluations; the link capacity is the maximum over those
+	static constexpr double SWITCH_MARGIN = .25; // a new preference has to be 25% cheaper ...
+	static constexpr size_t SWITCH_CONFIRMATIONS = 3; // ... in this many consecutive evaluations
+	static constexpr double MIN_DWELL = 5.; // seconds between changes
+	static constexpr double LAN_RTT = .002; // seconds; assumed capacity until the delivery rate was measured:
+	static constexpr double LAN_CAPACITY = 1e9; // bytes / second
+	static constexpr double WAN_CAPACITY = 1e6;
+
+	bool adaptiveEncodings = false;
+	std::unordered_map<int32_t, EncodingStats> windowStats;
+	std::unordered_map<int32_t, EncodingEstimate> estimates;
+	double windowDeliveryRate = 0;
+	std::deque<double> deliveryRates;
+	size_t updateStartTime = 0;
+	size_t updateStartBytes = 0;
+	size_t updateDecodeTicks = 0; // time spent decoding (not receiving) during the current update
+	size_t pullTicks = 0; // total time spent fetching data from the transport
+	size_t lastEvaluationTime = 0;
+	size_t lastSwitchTime = 0;
+	int32_t switchCandidate = 0;
+	size_t switchConfirmations = 0;
+
+	// SetEncodings:
+	std::vector<int32_t> pixelEncodings {
+		0, // Raw
+		1, // CopyRect
+		2, // RRE
+		4, // CoRRE
+		5, // Hextile
+		6, // Zlib
+		7, // Tight
+		15, // TRLE
+		16, // ZRLE
+	};
+	int compressLevel = -1;
+	int qualityLevel = -1;
+
+	// resumable parser state:
+	enum class ParseState : uint8_t {
+		MESSAGE_TYPE,
+		RECT_HEADER,
+		RECT_PAYLOAD
+	} parseState = ParseState::MESSAGE_TYPE;
+	size_t rectsLeft = 0; // of the current FramebufferUpdate (SIZE_MAX: until LastRect)
+	RectHeader rect; // currently received rect
+	size_t rectProgress = 0; // encoding specific (RAW: pixels written, Hextile / TRLE: tiles decoded)
+
+	// received data is parsed straight out of the transport's receive buffer (a view, valid until the next receive call on the transport);
+	// only a message that straddles reads is collected in rxBuffer, with as much of the next read as it needs
+	static constexpr size_t RX_CHUNK_SIZE = 64 * 1024;
+	static constexpr size_t RX_COMPACT_THRESHOLD = 64 * 1024;
+	static constexpr size_t RX_MIN_COPY = 4 * 1024; // taken from the next read at a time (messages of unknown size grow in few steps)
+	const uint8_t* rxData = nullptr; // received, partially parsed data: a transport view or rxBuffer
+	size_t rxSize = 0;
+	size_t rxPos = 0; // parse position in rxData
+	bool rxIsView = false;
+	std::vector<uint8_t> rxBuffer;
+	const uint8_t* rxNext = nullptr; // rest of the latest read (a view) while rxBuffer is parsed
+	size_t rxNextSize = 0;
+	size_t rxCopied = 0; // bytes at the end of rxBuffer that were copied from the latest read (they precede rxNext)
+	size_t rxConsumed = 0; // total bytes parsed
+
+	// FramebufferUpdateRequest scheduling:
+	static constexpr double REQUEST_TIMEOUT = 1.; // seconds
+	size_t maxInFlight = 2;
+	double maxRequestRate = 60.; // requests per second
+	std::deque<size_t> requestTimes; // send times of outstanding requests (performance counter)
+	size_t lastRequestTime = 0;
+	size_t lastUpdateTime = 0;
+	double smoothedRtt = 0; // seconds from request to completely received update
+	double smoothedUpdateInterval = 0;
+
+	// ContinuousUpdates / Fence:
+	static constexpr double FENCE_INTERVAL = .1; // seconds between latency probes
+	static constexpr double CONGESTION_FACTOR = 2.;
+	static constexpr double CONGESTION_SLACK = .02; // seconds
+	bool continuousUpdatesSupported = false;
+	bool continuousUpdatesWanted = false;
+	bool continuousUpdatesActive = false;
+	bool continuousUpdatesCongested = false; // temporarily back in request mode
+	bool continuousUpdatesEnding = false; // disabled, EndOfContinuousUpdates not received yet
+	bool fenceSupported = false;
+	size_t fencesInFlight = 0;
+	size_t lastFenceTime = 0;
+	size_t lastFenceResponseTime = 0;
+	size_t lastFenceResponseBytes = 0;
+	double smoothedFenceLatency = 0;
+	double minFenceLatency = 0;
+	double bandwidthEstimate = 0; // bytes per second
+
+	// progressive refresh: the whole framebuffer requested non-incrementally in tiles, nearest to the focus point first
+	struct RefreshTile {
+		uint16_t pos_x, pos_y, width, height;
+		size_t coveredPixels = 0; // received so far
+		bool requested = false;
+		bool done = false;
+	};
+
+	static constexpr uint16_t REFRESH_TILE_SIZE = 256;
+	static constexpr size_t REFRESH_MAX_IN_FLIGHT = 8; // tiles; enough to fill the link, few enough that servers do not merge them
+	std::vector<RefreshTile> refreshTiles; // row by row
+	std::vector<size_t> refreshPending; // unrequested tiles, nearest to the focus last
+	bool refreshActive = false;
+	size_t refreshTilesLeft = 0;
+	size_t refreshInFlight = 0;
+	size_t refreshStartTime = 0;
+	size_t lastRefreshProgress = 0;
+	double refreshFirstPixels = 0; // seconds from start until the first tile was complete
+	double refreshFullFrame = 0; // ... until all were
+	bool haveRefreshFocus = false; // framebuffer centre otherwise
+	uint16_t refreshFocusX = 0;
+	uint16_t refreshFocusY = 0;
+
+	// suspension (e.g. while the viewer is minimized):
+	enum class UpdateMode : uint8_t {
+		NORMAL,
+		SUSPENDED, // no requests at all
+		RESTRICTED // incremental requests for a region only, at a low rate
+	} updateMode = UpdateMode::NORMAL;
+	uint16_t restrictedX = 0, restrictedY = 0;
+	uint16_t restrictedWidth = 0, restrictedHeight = 0;
+	double restrictedRate = 1.; // requests per second
+	bool framebufferStale = false; // parts were not kept up to date; refreshed on resume
+
+	static inline Clock makeClock(const Transport& transport) {
+		if constexpr(std::is_constructible_v<Clock, const Transport&>)
+			return Clock(transport);
+		else
+			return Clock{};
+	}
+
+public:
+	template<typename... TransportArgs>
+	inline explicit BasicVNC(TransportArgs&&... transportArgs):
+			sock(std::forward<TransportArgs>(transportArgs)...),
+			clock(makeClock(sock)) {
+
+		printf("socket connection succeeded\n");
+
+		// Choose RFP Version:
+		const std::string& serverRFPVersion = sock.recvString(12);
+		std::cout << "Server Version: " << serverRFPVersion << "\n";
+
+		const char* version = "RFB 003.008\n";
+		sock.send(version, 12);
+
+		// Choose Security Type:
+		const uint8_t numSecurityTypes = sock.recvU8(); // receive number of security types
+		std::cout << "Num security types: " << static_cast<int>(numSecurityTypes) << "\n";
+
+		std::unordered_set<uint8_t> securityTypes;
+		for(size_t i = 0; i < numSecurityTypes; i++)
+			securityTypes.insert(sock.recvU8());
+
+		for(const uint8_t& securityType : securityTypes)
+			std::cout << " - SecurityType <" << static_cast<int>(securityType) << "> received\n";
+
+		if(securityTypes.find(1) != securityTypes.end()) { // None (no authentication required)
+			std::cout << "Authentication: None\n";
+
+			sock.sendU8(1); // send security type 1 (None)
+		} else if(securityTypes.find(2) != securityTypes.end()) { // VNC Authentication (DES challenge)
+			std::cout << "Authentication: VNC\n";
+
+			// Ask for Password:
+			std::string password;
+			std::cout << "Please input Password: ";
+			std::cin >> password;
+			std::cout << "You chose: \"" << password << "\"\n";
+
+			sock.sendU8(2); // send security type 2 (VNC authentication)
+
+			// Authenticate using VNC challenge:
+			std::array<uint8_t, 16> vncChallenge;
+			sock.recvExactly(vncChallenge.data(), 16); // receive random 16-byte vnc-auth challenge
+
+			std::array<uint8_t, 16> vncChallengeEncrypted = desEncrypt(vncChallenge, password); // Encrypt vnc-auth challenge
+			sock.send(vncChallengeEncrypted.data(), 16); // reply to vnc-auth challenge
+			std::cout << "Sent encrypted challenge back to server...\n";
+		}
+
+		const uint32_t securityResult = sock.recvU32(); // get SecurityResult handshake
+		if(securityResult != 0)
+			throw std::runtime_error("Security Handshake failed!"); // TODO: catch and show reason sent by server
+		std::cout << "SecurityResult Handshake: PASSED\n";
+
+
+		// Exchange init messages:
+		sock.sendU8(1); // send ClientInit (shared: true -> allow sharing session with other clients)
+
+		const ServerInit serverInit = recvServerInit();
+		const bool nativeFormat = identifyWireFormat(serverInit.pixelFormat, wireFormat); // 8 bit colour map: the colours arrive with SetColorMapEntries
+		if(!nativeFormat) { // no update was requested yet, so the switch needs no synchronization
+			wireFormat = WireFormat::BGRX32;
+			sendSetPixelFormat(wireFormat);
+		}
+		targetFormat = wireFormat;
+		resizeFramebuffer(serverInit.fbWidth, serverInit.fbHeight);
+
+		std::cout << "ServerInit:\n"
+			<< " - Width: " << serverInit.fbWidth << "  Height: " << serverInit.fbHeight << "  name: " << serverInit.name << "\n"
+			<< " - Pixel Format:\n"
+				<< "   - Bits per Pixel: " << (int)serverInit.pixelFormat.bits_per_pixel << "  depth: " << (int)serverInit.pixelFormat.depth << "\n"
+				<< "   - big_endian: " << std::boolalpha << (bool)serverInit.pixelFormat.big_endian_flag << "  true_color: " << (bool)serverInit.pixelFormat.true_color_flag << "\n"
+				<< "   - red_max: " << (int)serverInit.pixelFormat.red_max << "  green_max: " << (int)serverInit.pixelFormat.green_max << "  blue_max: " << (int)serverInit.pixelFormat.blue_max << "\n"
+				<< "   - red_shift: " << (int)serverInit.pixelFormat.red_shift << "  green_shift: " << (int)serverInit.pixelFormat.green_shift << "  blue_shift: " << (int)serverInit.pixelFormat.blue_shift << "\n";
+		if(!nativeFormat)
+			std::cout << "Unsupported pixel format, requested 32 bpp true colour instead\n";
+
+		// setEncodings:
+		sendEncodings();
+	}
+
+
+	// ---- Sending ----
+
+	inline void sendSetPixelFormat(const WireFormat format) const {
+		visitWireFormat(format, [&](auto traits) {
+			using Format = decltype(traits);
+			sock.sendU8(0); // MessageType (0 = SetPixelFormat)
+			sock.sendU8(0); // padding
+			sock.sendU16(0); // padding
+			sock.sendU8(Format::BITS_PER_PIXEL);
+			sock.sendU8(Format::DEPTH);
+			sock.sendU8(0); // big endian: false
+			sock.sendU8(Format::TRUE_COLOR);
+			sock.sendU16(Format::RED_MAX);
+			sock.sendU16(Format::GREEN_MAX);
+			sock.sendU16(Format::BLUE_MAX);
+			sock.sendU8(Format::RED_SHIFT);
+			sock.sendU8(Format::GREEN_SHIFT);
+			sock.sendU8(Format::BLUE_SHIFT);
+			sock.sendU8(0); // padding
+			sock.sendU16(0); // padding
+		});
+		sock.flush();
+	}
+
+	/**
+	 * Pixel format the server should send (SetPixelFormat); true colour formats end up as 32 bit pixels in pixel_data() either way.
+	 * RGB565 halves the bytes of most encodings at barely visible loss, BGR233 quarters them (visibly); PACKED24 saves a quarter
+	 * losslessly for Raw, RRE, Hextile and Zlib (ZRLE and Tight send 3 bytes per pixel anyway), but is not part of RFC 6143.
+	 * Sent by requestUpdates() once no update is outstanding (ContinuousUpdates pause meanwhile); takes effect with the next update.
+	*/
+	inline void setPixelFormat(const WireFormat format) {
+		targetFormat = format;
+		if(formatSwitch == FormatSwitch::AT_NEXT_UPDATE)
+			return; // compared again once that switch happened
+		formatSwitch = (targetFormat != wireFormat) ? FormatSwitch::UNSENT : FormatSwitch::NONE;
+		if(formatSwitch == FormatSwitch::UNSENT && continuousUpdatesActive)
+			sendEnableContinuousUpdates(false);
+		else if(formatSwitch == FormatSwitch::NONE)
+			resumeContinuousUpdates();
+	}
+
+	inline void sendUpdateRequest(const size_t posX, const size_t posY, const size_t width, const size_t height, const bool incremental = true) const {
+		sock.sendU8(3); // MessageType (3 = FrameBufferUpdateRequest)
+		sock.sendU8(incremental);
+		sock.sendU16(posX);
+		sock.sendU16(posY);
+		sock.sendU16(width);
+		sock.sendU16(height);
+		sock.flush();
+	}
+
+	/**
+	 * FramebufferUpdateRequest scheduler; call once per frame.
+	 * Sends a full-screen incremental request if fewer than maxInFlight requests are outstanding
+	 * and the previous one is at least 1 / maxRate old. Returns whether a request was sent.
+	*/
+	inline bool requestUpdates() {
+		const size_t now = clock.now();
+		const double freq = clock.frequency();
+
+		sendPendingPixelFormat(); // before the next request, which then gets answered in the new format
+
+		if(updateMode == UpdateMode::SUSPENDED)
+			return false; // not even latency probes: the server has nothing to do for this client
+		const bool restricted = updateMode == UpdateMode::RESTRICTED;
+
+		if(!restricted && fenceSupported && fencesInFlight == 0 && (now - lastFenceTime) / freq >= FENCE_INTERVAL) { // latency probe; the server answers once it handled everything sent before
+			sendFence(FENCE_REQUEST | FENCE_BLOCK_BEFORE, reinterpret_cast<const uint8_t*>(&now), sizeof(now));
+			fencesInFlight++;
+			lastFenceTime = now;
+		}
+
+		if(continuousUpdatesActive && fencesInFlight > 0 && minFenceLatency > 0 && (now - lastFenceTime) / freq > congestionThreshold())
+			pauseContinuousUpdates(); // the probe is stuck behind queued updates, no need to wait for its answer
+
+		if(refreshActive && !restricted)
+			return requestRefreshTiles(now, freq); // incremental requests wait, or the server would send everything at once
+
+		if(continuousUpdatesActive)
+			return false; // the server streams on its own
+
+		// servers may answer several pending requests with a single update; forget requests that went unanswered for too long
+		const double timeout = std::max(REQUEST_TIMEOUT, 4 * smoothedRtt);
+		while(!requestTimes.empty() && (now - requestTimes.front()) / freq > timeout)
+			requestTimes.pop_front();
+
+		if(requestTimes.size() >= (restricted ? 1 : maxInFlight))
+			return false;
+		const double rate = restricted ? std::min(restrictedRate, maxRequestRate) : maxRequestRate;
+		if(lastRequestTime != 0 && (now - lastRequestTime) / freq < 1. / rate)
+			return false;
+
+		if(restricted) {
+			const uint16_t posX = std::min(restrictedX, fb_width);
+			const uint16_t posY = std::min(restrictedY, fb_height);
+			const uint16_t width = std::min<size_t>(restrictedWidth, fb_width - posX);
+			const uint16_t height = std::min<size_t>(restrictedHeight, fb_height - posY);
+			if(width == 0 || height == 0)
+				return false;
+			sendUpdateRequest(posX, posY, width, height);
+		} else {
+			sendUpdateRequest(0, 0, fb_width, fb_height);
+		}
+		requestTimes.push_back(now);
+		lastRequestTime = now;
+		return true;
+	}
+
+	/**
+	 * ContinuousUpdates: the server streams updates for the whole framebuffer without waiting for requests.
+	 * Takes effect as soon as the server announced support (immediately, if it already did).
+	 * While active, requestUpdates() sends Fences instead of requests, to measure the end-to-end latency
+	 * and to fall back to request mode while the link is congested.
+	*/
+	inline void enableContinuousUpdates(const bool enable = true) {
+		continuousUpdatesWanted = enable;
+		if(enable)
+			resumeContinuousUpdates(); // not before a running progressive refresh finished or while updates are suspended
+		else if(continuousUpdatesSupported)
+			sendEnableContinuousUpdates(false);
+	}
+
+	inline void sendEnableContinuousUpdates(const bool enable) {
+		sock.sendU8(150); // MessageType (150 = EnableContinuousUpdates)
+		sock.sendU8(enable);
+		sock.sendU16(0);
+		sock.sendU16(0);
+		sock.sendU16(fb_width);
+		sock.sendU16(fb_height);
+		sock.flush();
+		if(!enable && continuousUpdatesActive)
+			continuousUpdatesEnding = true; // updates may still arrive until the server confirms
+		continuousUpdatesActive = enable;
+	}
+
+	inline void sendFence(const uint32_t flags, const uint8_t *const payload, const uint8_t length) const {
+		sock.sendU8(248); // MessageType (248 = Fence)
+		sock.sendU8(0); // padding
+		sock.sendU16(0); // padding
+		sock.sendU32(flags);
+		sock.sendU8(length);
+		sock.send(payload, length);
+		sock.flush();
+	}
+
+	/**
+	 * Pixel encodings to accept, in order of preference (re-sends SetEncodings).
+	 * The pseudo-encodings of all supported extensions are appended automatically.
+	 * ZYWRLE wavelet tiles are decoded for 32 bit true colour only: with any other pixel format (e.g. RGB565 on a slow link)
+	 * it is left out of SetEncodings, and announced again once the server sends BGRX32.
+	*/
+	inline void setEncodings(const std::vector<int32_t>& encodings) {
+		for(const int32_t encoding : encodings)
+			if(!isSupportedEncoding(encoding))
+				throw std::runtime_error("setEncodings(): encoding " + std::to_string(encoding) + " is not supported");
+
+		pixelEncodings = encodings;
+		sendEncodings();
+	}
+
+	// 0 (fastest) .. 9 (smallest); -1: server default. Re-sends SetEncodings
+	inline void setCompressLevel(const int level) {
+		if(level < -1 || level > 9)
+			throw std::runtime_error("setCompressLevel(): level has to be in [-1, 9]");
+
+		compressLevel = level;
+		sendEncodings();
+	}
+
+	// 0 (lowest) .. 9 (best) for lossy encodings (Tight JPEG, ZYWRLE wavelet levels); -1: server default. Re-sends SetEncodings
+	inline void setQualityLevel(const int level) {
+		if(level < -1 || level > 9)
+			throw std::runtime_error("setQualityLevel(): level has to be in [-1, 9]");
+
+		qualityLevel = level;
+		sendEncodings();
+	}
+
+	// announces the encodings for updates in the format the server sends from now on
+	inline void sendEncodings() const {
+		sendEncodings(serverFormat());
+	}
+
+	inline void sendEncodings(const WireFormat format) const {
+		std::vector<int32_t> encodings;
+		for(const int32_t encoding : pixelEncodings)
+			if(encoding != static_cast<int32_t>(RectHeader::EncodingType::ZYWRLE) || format == WireFormat::BGRX32)
+				encodings.push_back(encoding);
+		encodings.push_back(-239); // cursor pseudoencoding
+		encodings.push_back(-223); // desktopsize pseudoencoding
+		encodings.push_back(-308); // extended desktopsize pseudoencoding
+		encodings.push_back(-224); // lastrect pseudoencoding
+		encodings.push_back(-312); // fence pseudoencoding
+		encodings.push_back(-313); // continuous updates pseudoencoding
+		if(compressLevel >= 0)
+			encodings.push_back(static_cast<int32_t>(RectHeader::EncodingType::COMPRESS_LEVEL_0) + compressLevel);
+		if(qualityLevel >= 0)
+			encodings.push_back(static_cast<int32_t>(RectHeader::EncodingType::QUALITY_LEVEL_0) + qualityLevel);
+
+		sock.sendU8(2); // Type (= setEncodings)
+		sock.sendU8(0); // padding
+		sock.sendU16(encodings.size()); // numberOfEncodings
+		for(const int32_t& enc : encodings)
+			sock.sendS32(enc);
+		sock.flush();
+	}
+
+	/**
+	 * Adaptive encoding selection: measures bytes per pixel and decode time per pixel of each encoding
+	 * and the link's delivery rate, and moves the encoding with the lowest estimated time per pixel
+	 * (transfer + decode) to the front of the SetEncodings list.
+	 * Hysteresis: a new order has to be clearly better for several consecutive evaluations, and orders are kept for a minimum time.
+	*/
+	inline void setAdaptiveEncodings(const bool enable) {
+		adaptiveEncodings = enable;
+	}
+
+	inline void setUpdatePacing(const size_t maxInFlight, const double maxRate) {
+		this->maxInFlight = std::max<size_t>(maxInFlight, 1);
+		this->maxRequestRate = maxRate;
+	}
+
+	/**
+	 * Progressive refresh: re-requests the whole framebuffer non-incrementally, in tiles ordered by distance
+	 * from the focus point, so the area the user works in arrives first. The requests are sent by requestUpdates(),
+	 * which holds back incremental requests until all tiles were received. Started automatically on connect and on resizes.
+	*/
+	inline void refreshFramebuffer() {
+		refreshTiles.clear();
+		for(size_t y = 0; y < fb_height; y += REFRESH_TILE_SIZE)
+			for(size_t x = 0; x < fb_width; x += REFRESH_TILE_SIZE)
+				refreshTiles.push_back(RefreshTile {
+					static_cast<uint16_t>(x), static_cast<uint16_t>(y),
+					static_cast<uint16_t>(std::min<size_t>(REFRESH_TILE_SIZE, fb_width - x)),
+					static_cast<uint16_t>(std::min<size_t>(REFRESH_TILE_SIZE, fb_height - y))
+				});
+
+		refreshPending.resize(refreshTiles.size());
+		for(size_t i = 0; i < refreshPending.size(); i++)
+			refreshPending[i] = i;
+		sortRefreshTiles();
+
+		refreshActive = true;
+		refreshTilesLeft = refreshTiles.size();
+		refreshInFlight = 0;
+		refreshStartTime = lastRefreshProgress = clock.now();
+		refreshFirstPixels = 0;
+		refreshFullFrame = 0;
+		if(refreshTilesLeft == 0)
+			finishRefresh(refreshStartTime);
+	}
+
+	/**
+	 * Stops all update requests (and ContinuousUpdates), e.g. while the viewer is minimized, so the server stops encoding for this client.
+	 * Keep calling recvUpdates(): updates that were already requested still arrive.
+	*/
+	inline void suspendUpdates() {
+		updateMode = UpdateMode::SUSPENDED;
+		framebufferStale = true;
+		if(continuousUpdatesActive)
+			sendEnableContinuousUpdates(false);
+	}
+
+	// only keeps a region up to date (e.g. a thumbnail of the whole screen, or the area under the pointer), with at most maxRate requests per second
+	inline void restrictUpdates(const uint16_t posX, const uint16_t posY, const uint16_t width, const uint16_t height, const double maxRate) {
+		updateMode = UpdateMode::RESTRICTED;
+		restrictedX = posX;
+		restrictedY = posY;
+		restrictedWidth = width;
+		restrictedHeight = height;
+		restrictedRate = maxRate;
+		if(posX > 0 || posY > 0 || posX + width < fb_width || posY + height < fb_height)
+			framebufferStale = true;
+		if(continuousUpdatesActive)
+			sendEnableContinuousUpdates(false);
+	}
+
+	// back to normal updates; a framebuffer that was not kept up to date entirely is refreshed right away (progressively)
+	inline void resumeUpdates() {
+		if(updateMode == UpdateMode::NORMAL)
+			return;
+
+		updateMode = UpdateMode::NORMAL;
+		lastRequestTime = 0; // the next request may go out immediately
+		if(framebufferStale) {
+			framebufferStale = false;
+			refreshFramebuffer();
+		} else {
+			resumeContinuousUpdates();
+		}
+	}
+
+	// e.g. the pointer position; tiles that were not requested yet are reordered
+	inline void setRefreshFocus(const uint16_t posX, const uint16_t posY) {
+		if(haveRefreshFocus && posX == refreshFocusX && posY == refreshFocusY)
+			return;
+
+		haveRefreshFocus = true;
+		refreshFocusX = posX;
+		refreshFocusY = posY;
+		if(refreshActive)
+			sortRefreshTiles();
+	}
+
+	inline void sendPointerEvent(const uint16_t posX, const uint16_t posY, const uint8_t buttonMask) const {
+		sock.sendU8(5); // MessageType (5 = PointerEvent)
+		sock.sendU8(buttonMask);
+		sock.sendU16(posX);
+		sock.sendU16(posY);
+		sock.flush();
+	}
+
+	inline void sendKeyEvent(const bool downFlag, const uint32_t key) const {
+		sock.sendU8(4); // MessageType (4 = KeyEvent)
+		sock.sendU8(downFlag);
+		sock.sendU16(0); // padding
+		sock.sendU32(key);
+		sock.flush();
+	}
+
+
+	// ---- Receiving ----
+
+	inline ServerInit recvServerInit() const {
+		ServerInit serverInit;
+		serverInit.fbWidth = sock.recvU16();
+		serverInit.fbHeight = sock.recvU16();
+		serverInit.pixelFormat = recvPixelFormat();
+		serverInit.nameLength = sock.recvU32();
+		serverInit.name = sock.recvString(serverInit.nameLength);
+		return serverInit;
+	}
+
+	inline PixelFormat recvPixelFormat() const {
+		PixelFormat pixelFormat;
+		pixelFormat.bits_per_pixel  = sock.recvU8();
+		pixelFormat.depth           = sock.recvU8();
+		pixelFormat.big_endian_flag = sock.recvU8();
+		pixelFormat.true_color_flag = sock.recvU8();
+		pixelFormat.red_max   = sock.recvU16();
+		pixelFormat.green_max = sock.recvU16();
+		pixelFormat.blue_max  = sock.recvU16();
+		pixelFormat.red_shift   = sock.recvU8();
+		pixelFormat.green_shift = sock.recvU8();
+		pixelFormat.blue_shift  = sock.recvU8();
+
+		for(size_t i = 0; i < 3; i++)
+			sock.recvU8(); // receive padding
+
+		return pixelFormat;
+	}
+
+	/**
+	 * Processes whatever server data is available without blocking, until the time or byte budget is used up.
+	 * Parsing is resumable: a message (or rect) that is only partially received is continued on the next call,
+	 * RAW rects even pixel by pixel.
+	*/
+	inline UpdateSummary recvUpdates(const UpdateBudget& budget = UpdateBudget()) {
+		UpdateSummary summary;
+
+		const size_t start = clock.now();
+		const size_t maxTicks = budget.maxSeconds * clock.frequency();
+		const size_t consumedBefore = rxConsumed;
+		const size_t generationBefore = framebufferGeneration;
+		const size_t cursorGenerationBefore = cursorGeneration;
+		const size_t colorMapGenerationBefore = colorMapGeneration;
+
+		for(;;) {
+			summary.bytesReceived = rxConsumed - consumedBefore;
+			if(summary.bytesReceived > 0 && (summary.bytesReceived >= budget.maxBytes || clock.now() - start >= maxTicks)) {
+				keepUnparsed();
+				summary.budgetExhausted = rxAvailable() > 0 || sock.dataAvailable();
+				break;
+			}
+
+			if(!parseStep(summary))
+				break; // waiting for more data
+		}
+		keepUnparsed(); // the view does not outlive this call
+
+		adaptEncodings();
+
+		summary.cursorChanged = cursorGeneration != cursorGenerationBefore;
+		summary.colorMapChanged = colorMapGeneration != colorMapGenerationBefore;
+		summary.framebufferResized = framebufferGeneration != generationBefore;
+		if(summary.framebufferResized || summary.colorMapChanged) {
+			summary.dirtyX0 = 0;
+			summary.dirtyY0 = 0;
+			summary.dirtyX1 = fb_width;
+			summary.dirtyY1 = fb_height;
+		}
+
+		return summary;
+	}
+
+private:
+	enum class MessageType : uint8_t {
+		FRAMEBUFFER_UPDATE = 0,
+		SET_COLORMAP_ENTRIES = 1,
+		BELL = 2,
+		SERVER_CUT_TEXT = 3,
+		END_OF_CONTINUOUS_UPDATES = 150,
+		FENCE = 248
+	};
+
+	// Fence flags:
+	static constexpr uint32_t FENCE_BLOCK_BEFORE = 1 << 0;
+	static constexpr uint32_t FENCE_BLOCK_AFTER  = 1 << 1;
+	static constexpr uint32_t FENCE_SYNC_NEXT    = 1 << 2;
+	static constexpr uint32_t FENCE_REQUEST      = 1u << 31;
+	static constexpr uint32_t FENCE_SUPPORTED_FLAGS = FENCE_BLOCK_BEFORE | FENCE_BLOCK_AFTER | FENCE_SYNC_NEXT;
+
+	// ---- resumable parser ----
+
+	// advances the parser by one field / rect / chunk of rect data; returns false if more data has to arrive first
+	inline bool parseStep(UpdateSummary& summary) {
+		switch(parseState) {
+			case ParseState::MESSAGE_TYPE: {
+				if(!need(1)) return false;
+				const MessageType messageType = static_cast<MessageType>(rxU8());
+
+				switch(messageType) {
+					case MessageType::FRAMEBUFFER_UPDATE: {
+						if(!need(4)) return false;
+						const uint16_t numRects = rxU16(2); // skip padding
+						rectsLeft = (numRects == 0xFFFF) ? SIZE_MAX : numRects; // 0xFFFF: number of rects unknown, terminated by a LastRect rect
+						consume(4);
+						updateStartTime = clock.now();
+						updateStartBytes = rxConsumed;
+						updateDecodeTicks = 0;
+						if(formatSwitch == FormatSwitch::AT_NEXT_UPDATE)
+							switchPixelFormat();
+
+						summary.numFramebufferUpdates++;
+						if(rectsLeft == 0)
+							finishFramebufferUpdate(summary);
+						else
+							parseState = ParseState::RECT_HEADER;
+					} break;
+
+					case MessageType::SET_COLORMAP_ENTRIES: { // 16 bit red, green, blue per entry
+						if(!need(6)) return false;
+						const size_t firstColor = rxU16(2); // skip padding
+						const size_t numColors = rxU16(4);
+						if(!need(6 + numColors * 6)) return false;
+						if(firstColor + numColors > colorMapLUT.size())
+							throw std::runtime_error("SetColorMapEntries: entries " + std::to_string(firstColor) + " .. " + std::to_string(firstColor + numColors - 1) + " exceed the 8 bit colour map");
+
+						for(size_t i = 0; i < numColors; i++) {
+							const size_t off = 6 + i * 6;
+							colorMapLUT[firstColor + i] = rxU8(off + 4) | rxU8(off + 2) << 8 | rxU8(off) << 16; // high bytes
+						}
+						consume(6 + numColors * 6);
+						colorMapGeneration++;
+						cursorCache.clear(); // cached shapes were expanded through the old colours
+						finishMessage(summary);
+					} break;
+
+					case MessageType::BELL: {
+						consume(1);
+						std::cout << "<BELL>\n";
+						summary.numBells++;
+						finishMessage(summary);
+					} break;
+
+					case MessageType::SERVER_CUT_TEXT: {
+						if(!need(8)) return false;
+						const uint32_t clipboardLength = rxU32(4); // skip type and padding
+						if(!need(8 + clipboardLength)) return false;
+
+						summary.cutTexts.emplace_back(reinterpret_cast<const char*>(rxData + rxPos + 8), clipboardLength);
+						consume(8 + clipboardLength);
+						std::cout << "Received Clipboard \"" << summary.cutTexts.back() << "\"\n";
+						finishMessage(summary);
+					} break;
+
+					case MessageType::END_OF_CONTINUOUS_UPDATES: { // announces support, later confirms disabling
+						consume(1);
+						if(!continuousUpdatesSupported) {
+							continuousUpdatesSupported = true;
+							resumeContinuousUpdates();
+						} else {
+							continuousUpdatesActive = false;
+							continuousUpdatesEnding = false;
+						}
+						finishMessage(summary);
+					} break;
+
+					case MessageType::FENCE: {
+						if(!need(9)) return false;
+						const uint32_t flags = rxU32(4); // skip type and padding
+						const uint8_t length = rxU8(8);
+						if(!need(9 + length)) return false;
+
+						const uint8_t *const payload = rxData + rxPos + 9;
+						if(flags & FENCE_REQUEST) {
+							// messages are handled strictly in order, which satisfies all flags; echo the fence back
+							fenceSupported = true;
+							sendFence(flags & FENCE_SUPPORTED_FLAGS, payload, length);
+						} else if(length == sizeof(size_t) && fencesInFlight > 0) {
+							onFenceResponse(payload);
+						}
+						consume(9 + length);
+						finishMessage(summary);
+					} break;
+
+					default:
+						throw std::runtime_error("Received update of non-zero type " + std::to_string(static_cast<uint8_t>(messageType)));
+				}
+			} break;
+
+			case ParseState::RECT_HEADER: {
+				if(!need(12)) return false;
+				rect.pos_x  = rxU16(0);
+				rect.pos_y  = rxU16(2);
+				rect.width  = rxU16(4);
+				rect.height = rxU16(6);
+				rect.encoding_type = static_cast<typename RectHeader::EncodingType>(rxU32(8));
+				consume(12);
+
+				if(rect.encoding_type != RectHeader::EncodingType::LASTRECT_PSEUDOENCODING)
+					summary.numRects++;
+
+				// std::cout << "Rect:\n"
+				// 	<< "  pos_x: " << rect.pos_x << " pos_y: " << rect.pos_y << "\n"
+				// 	<< "  width: " << rect.width << " height: " << rect.height << "\n"
+				// 	<< "  encoding_type: " << static_cast<int>(rect.encoding_type) << "\n";
+
+				if(static_cast<int32_t>(rect.encoding_type) >= 0) { // pseudo-encodings do not touch the framebuffer
+					// the decoders write without clipping, so a rect has to lie within the framebuffer:
+					if(static_cast<size_t>(rect.pos_x) + rect.width > fb_width || static_cast<size_t>(rect.pos_y) + rect.height > fb_height)
+						throw std::runtime_error("Rect " + std::to_string(rect.width) + "x" + std::to_string(rect.height) + " at " + std::to_string(rect.pos_x) + ", " + std::to_string(rect.pos_y)
+							+ " exceeds the " + std::to_string(fb_width) + "x" + std::to_string(fb_height) + " framebuffer");
+
+					if(rect.width > 0 && rect.height > 0) {
+						summary.dirtyX0 = std::min<uint32_t>(summary.dirtyX0, rect.pos_x);
+						summary.dirtyY0 = std::min<uint32_t>(summary.dirtyY0, rect.pos_y);
+						summary.dirtyX1 = std::max<uint32_t>(summary.dirtyX1, static_cast<uint32_t>(rect.pos_x) + rect.width);
+						summary.dirtyY1 = std::max<uint32_t>(summary.dirtyY1, static_cast<uint32_t>(rect.pos_y) + rect.height);
+					}
+				}
+
+				rectProgress = 0;
+				parseState = ParseState::RECT_PAYLOAD;
+			} break;
+
+			case ParseState::RECT_PAYLOAD: {
+				const size_t consumedBefore = rxConsumed;
+				const size_t decodeStart = clock.now();
+				const size_t pullTicksBefore = pullTicks;
+				const bool complete = recvUpdateRect(rect);
+				const size_t decodeTicks = clock.now() - decodeStart - (pullTicks - pullTicksBefore);
+				updateDecodeTicks += decodeTicks;
+				recordDecode(rect, rxConsumed - consumedBefore, decodeTicks, complete);
+				if(!complete)
+					return rxConsumed != consumedBefore; // rect incomplete; made progress if it parsed anything
+
+				if(refreshActive && static_cast<int32_t>(rect.encoding_type) >= 0)
+					coverRefreshTiles(rect);
+
+				if(rect.encoding_type == RectHeader::EncodingType::LASTRECT_PSEUDOENCODING || --rectsLeft == 0)
+					finishFramebufferUpdate(summary);
+				else
+					parseState = ParseState::RECT_HEADER;
+			} break;
+		}
+
+		return true;
+	}
+
+	inline void finishMessage(UpdateSummary& summary) {
+		summary.numMessages++;
+		parseState = ParseState::MESSAGE_TYPE;
+	}
+
+	// payload holds the send time of one of our latency probes
+	inline void onFenceResponse(const uint8_t *const payload) {
+		size_t sendTime;
+		memcpy(&sendTime, payload, sizeof(sendTime));
+
+		const size_t now = clock.now();
+		const double freq = clock.frequency();
+		const double sample = (now - sendTime) / freq;
+		fencesInFlight--;
+
+		smoothedFenceLatency = (smoothedFenceLatency == 0) ? sample : smoothedFenceLatency + (sample - smoothedFenceLatency) / 8;
+		minFenceLatency = (minFenceLatency == 0) ? sample : std::min(minFenceLatency, sample);
+
+		if(lastFenceResponseTime != 0 && now > lastFenceResponseTime)
+			bandwidthEstimate = (rxConsumed - lastFenceResponseBytes) * freq / (now - lastFenceResponseTime);
+		lastFenceResponseTime = now;
+		lastFenceResponseBytes = rxConsumed;
+
+		// flow control: a growing queue in front of the client shows up as latency far above the unloaded minimum
+		if(continuousUpdatesActive && sample > congestionThreshold()) {
+			pauseContinuousUpdates();
+		} else if(continuousUpdatesCongested && sample < (1 + CONGESTION_FACTOR) / 2 * minFenceLatency + CONGESTION_SLACK / 2) {
+			continuousUpdatesCongested = false;
+			resumeContinuousUpdates();
+		}
+	}
+
+	inline double congestionThreshold() const {
+		return CONGESTION_FACTOR * minFenceLatency + CONGESTION_SLACK;
+	}
+
+	inline bool requestRefreshTiles(const size_t now, const double freq) {
+		// a server that leaves a request (partially) unanswered must not hold back updates forever
+		if(refreshInFlight > 0 && (now - lastRefreshProgress) / freq > std::max(REQUEST_TIMEOUT, 4 * smoothedRtt)) {
+			finishRefresh(now);
+			return false;
+		}
+
+		bool sent = false;
+		while(refreshInFlight < REFRESH_MAX_IN_FLIGHT && !refreshPending.empty()) {
+			RefreshTile& tile = refreshTiles[refreshPending.back()];
+			refreshPending.pop_back();
+			if(tile.done)
+				continue; // already covered by other updates
+
+			sendUpdateRequest(tile.pos_x, tile.pos_y, tile.width, tile.height, false);
+			tile.requested = true;
+			refreshInFlight++;
+			sent = true;
+		}
+
+		if(sent)
+			lastRefreshProgress = now;
+		return sent;
+	}
+
+	inline void sortRefreshTiles() {
+		const double focusX = haveRefreshFocus ? refreshFocusX : fb_width / 2.;
+		const double focusY = haveRefreshFocus ? refreshFocusY : fb_height / 2.;
+		const auto distance = [&](const size_t index) {
+			const RefreshTile& tile = refreshTiles[index];
+			const double dx = tile.pos_x + tile.width / 2. - focusX;
+			const double dy = tile.pos_y + tile.height / 2. - focusY;
+			return dx * dx + dy * dy;
+		};
+		std::sort(refreshPending.begin(), refreshPending.end(), [&](const size_t a, const size_t b) { return distance(a) > distance(b); });
+	}
+
+	// counts the pixels of a received rect towards the tiles it overlaps; a tile is answered once it is fully covered
+	inline void coverRefreshTiles(const RectHeader& rectHeader) {
+		const size_t x0 = std::min<size_t>(rectHeader.pos_x, fb_width);
+		const size_t y0 = std::min<size_t>(rectHeader.pos_y, fb_height);
+		const size_t x1 = std::min<size_t>(rectHeader.pos_x + rectHeader.width, fb_width);
+		const size_t y1 = std::min<size_t>(rectHeader.pos_y + rectHeader.height, fb_height);
+		if(x0 >= x1 || y0 >= y1)
+			return;
+
+		const size_t now = clock.now();
+		const double freq = clock.frequency();
+		const size_t tilesPerRow = (fb_width + REFRESH_TILE_SIZE - 1) / REFRESH_TILE_SIZE;
+
+		for(size_t ty = y0 / REFRESH_TILE_SIZE; ty * REFRESH_TILE_SIZE < y1; ty++) {
+			for(size_t tx = x0 / REFRESH_TILE_SIZE; tx * REFRESH_TILE_SIZE < x1; tx++) {
+				RefreshTile& tile = refreshTiles[ty * tilesPerRow + tx];
+				if(tile.done)
+					continue;
+
+				const size_t overlapX = std::min<size_t>(x1, tile.pos_x + tile.width) - std::max<size_t>(x0, tile.pos_x);
+				const size_t overlapY = std::min<size_t>(y1, tile.pos_y + tile.height) - std::max<size_t>(y0, tile.pos_y);
+				tile.coveredPixels += overlapX * overlapY;
+				if(tile.coveredPixels < static_cast<size_t>(tile.width) * tile.height)
+					continue;
+
+				tile.done = true;
+				refreshTilesLeft--;
+				if(tile.requested)
+					refreshInFlight--;
+				lastRefreshProgress = now;
+				if(refreshFirstPixels == 0)
+					refreshFirstPixels = (now - refreshStartTime) / freq;
+			}
+		}
+
+		if(refreshTilesLeft == 0)
+			finishRefresh(now);
+	}
+
+	inline void finishRefresh(const size_t now) {
+		refreshActive = false;
+		refreshPending.clear();
+		refreshFullFrame = (now - refreshStartTime) / static_cast<double>(clock.frequency());
+
+		resumeContinuousUpdates();
+	}
+
+	// starts streaming if it is wanted and nothing holds it back
+	inline void resumeContinuousUpdates() {
+		if(continuousUpdatesWanted && continuousUpdatesSupported && !continuousUpdatesActive && !continuousUpdatesCongested
+				&& !refreshActive && updateMode == UpdateMode::NORMAL && formatSwitch == FormatSwitch::NONE)
+			sendEnableContinuousUpdates(true);
+	}
+
+	// the server's pixel format for a format of ours (depth aside: some servers announce 32 for 24 bit colour)
+	static inline bool identifyWireFormat(const PixelFormat& pixelFormat, WireFormat& format) {
+		for(const WireFormat candidate : { WireFormat::BGRX32, WireFormat::PACKED24, WireFormat::RGB565, WireFormat::BGR233, WireFormat::INDEXED8 }) {
+			const bool match = visitWireFormat(candidate, [&](auto traits) {
+				using Format = decltype(traits);
+				if(pixelFormat.bits_per_pixel != Format::BITS_PER_PIXEL || static_cast<bool>(pixelFormat.true_color_flag) != Format::TRUE_COLOR)
+					return false;
+				return !Format::TRUE_COLOR || ((!pixelFormat.big_endian_flag || Format::BITS_PER_PIXEL == 8)
+					&& pixelFormat.red_max == Format::RED_MAX && pixelFormat.green_max == Format::GREEN_MAX && pixelFormat.blue_max == Format::BLUE_MAX
+					&& pixelFormat.red_shift == Format::RED_SHIFT && pixelFormat.green_shift == Format::GREEN_SHIFT && pixelFormat.blue_shift == Format::BLUE_SHIFT);
+			});
+			if(match) {
+				format = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// sends a requested format once nothing is outstanding that the server could still send in the current one
+	inline void sendPendingPixelFormat() {
+		if(formatSwitch != FormatSwitch::UNSENT || continuousUpdatesActive || continuousUpdatesEnding || !requestTimes.empty()
+				|| (refreshActive && refreshInFlight > 0) || parseState != ParseState::MESSAGE_TYPE)
+			return;
+
+		// ZYWRLE comes and goes with BGRX32; never announced while the server could send it in another format:
+		const bool zywrleWanted = std::find(pixelEncodings.begin(), pixelEncodings.end(), static_cast<int32_t>(RectHeader::EncodingType::ZYWRLE)) != pixelEncodings.end();
+		const bool zywrleChanges = zywrleWanted && (targetFormat == WireFormat::BGRX32) != (wireFormat == WireFormat::BGRX32);
+		if(zywrleChanges && targetFormat != WireFormat::BGRX32)
+			sendEncodings(targetFormat);
+
+		sendSetPixelFormat(targetFormat);
+		sentFormat = targetFormat;
+		formatSwitch = FormatSwitch::AT_NEXT_UPDATE;
+
+		if(zywrleChanges && targetFormat == WireFormat::BGRX32)
+			sendEncodings();
+	}
+
+	// format of the updates the server generates from now on (the latest SetPixelFormat may not have taken effect yet)
+	inline WireFormat serverFormat() const {
+		return (formatSwitch == FormatSwitch::AT_NEXT_UPDATE) ? sentFormat : wireFormat;
+	}
+
+	// the current FramebufferUpdate is the first in sentFormat
+	inline void switchPixelFormat() {
+		const size_t bytesBefore = bytesPerPixel();
+		wireFormat = sentFormat;
+		formatSwitch = (targetFormat != wireFormat) ? FormatSwitch::UNSENT : FormatSwitch::NONE;
+		cursorCache.clear(); // keyed by wire data
+		if(bytesPerPixel() != bytesBefore)
+			resizeFramebuffer(fb_width, fb_height); // colour map indices <-> colours: reallocated and refreshed
+		resumeContinuousUpdates();
+	}
+
+	inline void pauseContinuousUpdates() {
+		sendEnableContinuousUpdates(false); // request mode paces itself by the in-flight depth
+		continuousUpdatesCongested = true;
+	}
+
+	inline void finishFramebufferUpdate(UpdateSummary& summary) {
+		const size_t now = clock.now();
+		const double freq = clock.frequency();
+
+		if(!requestTimes.empty()) { // answer to the oldest outstanding request
+			const double sample = (now - requestTimes.front()) / freq;
+			smoothedRtt = (smoothedRtt == 0) ? sample : smoothedRtt + (sample - smoothedRtt) / 8; // like TCP's SRTT
+			requestTimes.pop_front();
+		}
+
+		if(lastUpdateTime != 0) {
+			const double interval = (now - lastUpdateTime) / freq;
+			smoothedUpdateInterval = (smoothedUpdateInterval == 0) ? interval : smoothedUpdateInterval + (interval - smoothedUpdateInterval) / 8;
+		}
+		lastUpdateTime = now;
+
+		// delivery rate of large updates (small ones arrive in a single chunk and say nothing about the link);
+		// decoding time is excluded, since it would make a slow decoder look like a slow link:
+		const size_t updateBytes = rxConsumed - updateStartBytes;
+		const size_t deliveryTicks = now - updateStartTime - std::min(updateDecodeTicks, now - updateStartTime);
+		if(updateBytes >= DELIVERY_RATE_MIN_BYTES && deliveryTicks > 0)
+			windowDeliveryRate = std::max(windowDeliveryRate, updateBytes * freq / deliveryTicks);
+
+		finishMessage(summary);
+	}
+
+	// makes sure numBytes unconsumed bytes are buffered, as far as the transport has them available without blocking
+	inline bool need(const size_t numBytes) {
+		while(rxAvailable() < numBytes) {
+			if(rxNextSize == 0) {
+				keepUnparsed();
+				if(!sock.dataAvailable())
+					return false;
+				pull();
+			}
+
+			if(rxAvailable() <= rxCopied) { // no message straddles reads (any more): parse the rest of the read where the transport received it
+				rxData = rxNext - rxAvailable();
+				rxSize = rxAvailable() + rxNextSize;
+				rxPos = 0;
+				rxIsView = true;
+				rxNextSize = 0;
+				rxCopied = 0;
+				rxBuffer.clear();
+			} else { // a message straddles reads
+				if(rxPos >= RX_COMPACT_THRESHOLD && rxPos * 2 >= rxBuffer.size()) { // drop consumed data (amortized, since at least half of the buffer is consumed)
+					rxBuffer.erase(rxBuffer.begin(), rxBuffer.begin() + rxPos);
+					rxPos = 0;
+				}
+				const size_t len = std::min(rxNextSize, std::max(numBytes - rxAvailable(), RX_MIN_COPY));
+				rxBuffer.insert(rxBuffer.end(), rxNext, rxNext + len);
+				rxNext += len;
+				rxNextSize -= len;
+				rxCopied += len;
+				rxData = rxBuffer.data();
+				rxSize = rxBuffer.size();
+			}
+		}
+		return true;
+	}
+
+	inline void pull() {
+		const size_t start = clock.now();
+		const auto [data, len] = sock.recvChunk(RX_CHUNK_SIZE);
+		rxNext = data;
+		rxNextSize = len;
+		rxCopied = 0;
+		pullTicks += clock.now() - start;
+	}
+
+	// moves all received, unparsed data into rxBuffer; required before the next receive call on the transport (it invalidates views)
+	inline void keepUnparsed() {
+		if(rxIsView) {
+			rxBuffer.assign(rxData + rxPos, rxData + rxSize);
+			rxPos = 0;
+			rxIsView = false;
+		}
+		rxBuffer.insert(rxBuffer.end(), rxNext, rxNext + rxNextSize);
+		rxNextSize = 0;
+		rxCopied = 0;
+		rxData = rxBuffer.data();
+		rxSize = rxBuffer.size();
+	}
+
+	inline size_t rxAvailable() const {
+		return rxSize - rxPos;
+	}
+
+	inline void consume(const size_t numBytes) {
+		rxPos += numBytes;
+		rxConsumed += numBytes;
+	}
+
+	// big-endian fields at an offset from the current parse position (has to be buffered already)
+	inline uint8_t rxU8(const size_t offset = 0) const {
+		return rxData[rxPos + offset];
+	}
+
+	inline uint16_t rxU16(const size_t offset = 0) const {
+		return rxU8(offset) << 8 | rxU8(offset + 1);
+	}
+
+	inline uint32_t rxU32(const size_t offset = 0) const {
+		return static_cast<uint32_t>(rxU16(offset)) << 16 | rxU16(offset + 2);
+	}
+
+	// returns false if the rect is not complete yet
+	inline bool recvUpdateRect(const RectHeader& rectHeader) {
+		return visitWireFormat(wireFormat, [&](auto format) { return decodeRect<decltype(format)>(rectHeader); });
+	}
+
+	// Format: pixels on the wire (PixelFormats.hpp); Format::Pixel is the framebuffer pixel, uint8_t (colour map index) or uint32_t (blue | green << 8 | red << 16)
+	template<typename Format>
+	inline bool decodeRect(const RectHeader& rectHeader) {
+		switch(rectHeader.encoding_type) {
+			case RectHeader::EncodingType::RAW:
+				return recvUpdateRectRAW<Format>(rectHeader);
+			case RectHeader::EncodingType::COPYRECT:
+				return recvUpdateRectCOPYRECT<Format>(rectHeader);
+			case RectHeader::EncodingType::RRE:
+				return recvUpdateRectRRE<Format>(rectHeader, false);
+			case RectHeader::EncodingType::CORRE:
+				return recvUpdateRectRRE<Format>(rectHeader, true);
+			case RectHeader::EncodingType::HEXTILE:
+				return recvUpdateRectHEXTILE<Format>(rectHeader);
+			case RectHeader::EncodingType::ZLIB:
+				return recvUpdateRectZLIB<Format>(rectHeader);
+			case RectHeader::EncodingType::TIGHT:
+				return recvUpdateRectTIGHT<Format>(rectHeader);
+			case RectHeader::EncodingType::TRLE:
+				return recvUpdateRectTRLE<Format>(rectHeader);
+			case RectHeader::EncodingType::ZRLE:
+				return recvUpdateRectZRLE<Format>(rectHeader);
+			case RectHeader::EncodingType::ZYWRLE:
+				return recvUpdateRectZRLE<Format>(rectHeader, zywrleLevel());
+			case RectHeader::EncodingType::CURSOR_PSEUDOENCODING:
+				return recvCursor<Format>(rectHeader);
+			case RectHeader::EncodingType::DESKTOPSIZE_PSEUDOENCODING:
+				resizeFramebuffer(rectHeader.width, rectHeader.height);
+				return true;
+			case RectHeader::EncodingType::EXTENDED_DESKTOPSIZE_PSEUDOENCODING:
+				return recvExtendedDesktopSize(rectHeader);
+			case RectHeader::EncodingType::LASTRECT_PSEUDOENCODING: // no payload; ends the FramebufferUpdate
+				return true;
+			default:
+				throw std::runtime_error("Error: unknown update-rect encoding type " + std::to_string(static_cast<int>(rectHeader.encoding_type)));
+		}
+	}
+
+	inline void recordDecode(const RectHeader& rectHeader, const size_t bytes, const size_t ticks, const bool complete) {
+		if(!adaptiveEncodings || static_cast<int32_t>(rectHeader.encoding_type) < 0)
+			return;
+
+		EncodingStats& stats = windowStats[static_cast<int32_t>(rectHeader.encoding_type)];
+		stats.bytes += bytes;
+		stats.ticks += ticks;
+		if(complete)
+			stats.pixels += rectHeader.width * rectHeader.height;
+	}
+
+	static inline EncodingEstimate encodingPrior(const int32_t encoding) {
+		switch(static_cast<typename RectHeader::EncodingType>(encoding)) {
+			case RectHeader::EncodingType::RAW:     return EncodingEstimate { 4., .5e-9, false };
+			case RectHeader::EncodingType::RRE:     return EncodingEstimate { 2., 1e-9, false }; // compact only for flat content
+			case RectHeader::EncodingType::CORRE:   return EncodingEstimate { 2., 1e-9, false };
+			case RectHeader::EncodingType::HEXTILE: return EncodingEstimate { 1., 1e-9, false };
+			case RectHeader::EncodingType::ZLIB:    return EncodingEstimate { .8, 4e-9, false }; // no tile analysis on the server
+			case RectHeader::EncodingType::TIGHT:   return EncodingEstimate { .4, 5e-9, false }; // zlib on filtered data beats ZRLE on mixed content
+			case RectHeader::EncodingType::TRLE:    return EncodingEstimate { 1., 2e-9, false };
+			case RectHeader::EncodingType::ZRLE:    return EncodingEstimate { .5, 5e-9, false };
+			case RectHeader::EncodingType::ZYWRLE:  return EncodingEstimate { .2, 7e-9, false }; // lossy
+			default:                                return EncodingEstimate { 1., 5e-9, false };
+		}
+	}
+
+	inline const EncodingEstimate& estimate(const int32_t encoding) {
+		return estimates.emplace(encoding, encodingPrior(encoding)).first->second;
+	}
+
+	inline void adaptEncodings() {
+		if(!adaptiveEncodings)
+			return;
+
+		const size_t now = clock.now();
+		const double freq = clock.frequency();
+		if(lastEvaluationTime == 0)
+			lastEvaluationTime = lastSwitchTime = now;
+		if((now - lastEvaluationTime) / freq < EVALUATION_INTERVAL)
+			return;
+		lastEvaluationTime = now;
+
+		// fold this window's measurements into the estimates:
+		for(const auto& [encoding, stats] : windowStats) {
+			if(stats.pixels < MIN_SAMPLE_PIXELS)
+				continue;
+
+			EncodingEstimate& est = estimates.emplace(encoding, encodingPrior(encoding)).first->second;
+			const double bytesPerPixel = stats.bytes * 1. / stats.pixels;
+			const double secondsPerPixel = stats.ticks / freq / stats.pixels;
+			est.bytesPerPixel   = est.measured ? est.bytesPerPixel   + (bytesPerPixel   - est.bytesPerPixel)   / 4 : bytesPerPixel;
+			est.secondsPerPixel = est.measured ? est.secondsPerPixel + (secondsPerPixel - est.secondsPerPixel) / 4 : secondsPerPixel;
+			est.measured = true;
+		}
+		windowStats.clear();
+
+		if(windowDeliveryRate > 0) {
+			deliveryRates.push_back(windowDeliveryRate);
+			if(deliveryRates.size() > DELIVERY_RATE_HISTORY)
+				deliveryRates.pop_front();
+			windowDeliveryRate = 0;
+		}
+
+		const double capacity = linkCapacity();
+		if(capacity <= 0)
+			return;
+
+		// cheapest candidate (CopyRect is not an alternative to the others; it is used whenever it is in the list):
+		const auto cost = [&](const int32_t encoding) {
+			const EncodingEstimate& est = estimate(encoding);
+			return est.bytesPerPixel / capacity + est.secondsPerPixel;
+		};
+
+		int32_t current = 0;
+		bool haveCurrent = false;
+		int32_t best = 0;
+		bool haveBest = false;
+		for(const int32_t encoding : pixelEncodings) {
+			if(encoding == static_cast<int32_t>(RectHeader::EncodingType::COPYRECT))
+				continue;
+			if(encoding == static_cast<int32_t>(RectHeader::EncodingType::ZYWRLE) && serverFormat() != WireFormat::BGRX32)
+				continue; // not announced
+			if(!haveCurrent) {
+				current = encoding;
+				haveCurrent = true;
+			}
+			if(!haveBest || cost(encoding) < cost(best)) {
+				best = encoding;
+				haveBest = true;
+			}
+		}
+
+		if(!haveBest || best == current || cost(best) > (1 - SWITCH_MARGIN) * cost(current)) {
+			switchConfirmations = 0;
+			return;
+		}
+
+		switchConfirmations = (best == switchCandidate) ? switchConfirmations + 1 : 1;
+		switchCandidate = best;
+		if(switchConfirmations < SWITCH_CONFIRMATIONS || (now - lastSwitchTime) / freq < MIN_DWELL)
+			return;
+
+		// move the winner in front of the previous preference:
+		pixelEncodings.erase(std::find(pixelEncodings.begin(), pixelEncodings.end(), best));
+		pixelEncodings.insert(std::find(pixelEncodings.begin(), pixelEncodings.end(), current), best);
+		sendEncodings();
+
+		lastSwitchTime = now;
+		switchConfirmations = 0;
+	}
+
+	static inline bool isSupportedEncoding(const int32_t encoding) {
+		switch(static_cast<typename RectHeader::EncodingType>(encoding)) {
+			case RectHeader::EncodingType::RAW:
+			case RectHeader::EncodingType::COPYRECT:
+			case RectHeader::EncodingType::RRE:
+			case RectHeader::EncodingType::CORRE:
+			case RectHeader::EncodingType::HEXTILE:
+			case RectHeader::EncodingType::ZLIB:
+			case RectHeader::EncodingType::TIGHT:
+			case RectHeader::EncodingType::TRLE:
+			case RectHeader::EncodingType::ZRLE:
+			case RectHeader::EncodingType::ZYWRLE:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	// ---- updaterect type implementations ----
+
+	// pos_x: reason (0 = server side change, 1 = requested by this client, 2 = requested by another client), pos_y: status code
+	inline bool recvExtendedDesktopSize(const RectHeader& rectHeader) {
+		if(!need(4)) return false;
+		const uint8_t numScreens = rxU8();
+		if(!need(4 + numScreens * 16)) return false;
+
+		std::vector<Screen> screens(numScreens);
+		for(size_t i = 0; i < numScreens; i++) {
+			const size_t off = 4 + i * 16;
+			screens[i] = Screen { rxU32(off), rxU16(off + 4), rxU16(off + 6), rxU16(off + 8), rxU16(off + 10), rxU32(off + 12) };
+		}
+		consume(4 + numScreens * 16);
+
+		const bool failedRequest = rectHeader.pos_x == 1 && rectHeader.pos_y != 0;
+		if(!failedRequest) {
+			screenLayout = std::move(screens);
+			if(rectHeader.width != fb_width || rectHeader.height != fb_height)
+				resizeFramebuffer(rectHeader.width, rectHeader.height);
+		}
+		return true;
+	}
+
+	// reallocates within the existing capacity where possible; the zlib streams of ZRLE and Tight survive resizes (it is per connection)
+	inline void resizeFramebuffer(const uint16_t width, const uint16_t height) {
+		fb_width = width;
+		fb_height = height;
+		pixelData.assign(static_cast<size_t>(width) * height * bytesPerPixel(), 0);
+		framebufferGeneration++;
+
+		rectProgress = 0;
+		requestTimes.clear(); // requests for the old size
+		if(continuousUpdatesActive)
+			sendEnableContinuousUpdates(true); // update the streamed area
+		refreshFramebuffer(); // the content of the new framebuffer is undefined until received
+
+		if(resizeCallback)
+			resizeCallback(width, height);
+	}
+
+	std::shared_ptr<const CursorShape> cursorShape; // nullptr: hidden (or not sent yet)
+	size_t cursorGeneration = 0; // incremented on every shape change
+	CursorCache cursorCache;
+
+	// pos_x, pos_y: hotspot; pixels in the pixel format of the framebuffer, then a bitmask (rows padded to whole bytes, MSB first)
+	template<typename Format>
+	inline bool recvCursor(const RectHeader& rectHeader) {
+		const size_t BYTES_PER_PIXEL = Format::SIZE;
+		const size_t width = rectHeader.width;
+		const size_t height = rectHeader.height;
+		const size_t maskStride = (width + 7) / 8;
+		const size_t cursorBytes = width * height * BYTES_PER_PIXEL + maskStride * height;
+		if(!need(cursorBytes)) return false;
+
+		if(width == 0 || height == 0) {
+			cursorShape = nullptr;
+		} else {
+			const uint8_t *const data = rxData + rxPos;
+			cursorShape = cursorCache.get(data, cursorBytes, width, height, rectHeader.pos_x, rectHeader.pos_y, [&]() {
+				CursorShape shape;
+				shape.width = width;
+				shape.height = height;
+				shape.hotX = rectHeader.pos_x;
+				shape.hotY = rectHeader.pos_y;
+				shape.pixels.resize(width * height);
+
+				const uint8_t *const mask = data + width * height * BYTES_PER_PIXEL;
+				for(size_t y = 0; y < height; y++) {
+					for(size_t x = 0; x < width; x++) {
+						const bool opaque = mask[y * maskStride + x / 8] & (0x80 >> (x % 8));
+						const uint32_t color = Format::TRUE_COLOR ? Format::read(data + (y * width + x) * BYTES_PER_PIXEL) : colorMapLUT[data[y * width + x]];
+						shape.pixels[y * width + x] = opaque ? (color & 0x00FFFFFF) | 0xFF000000 : 0;
+					}
+				}
+				return shape;
+			});
+		}
+
+		consume(cursorBytes);
+		cursorGeneration++;
+		return true;
+	}
+
+	template<typename Format>
+	inline bool recvUpdateRectRAW(const RectHeader& rectHeader) {
+		using Pixel = typename Format::Pixel;
+		const size_t BYTES_PER_PIXEL = Format::SIZE;
+
+		const size_t numPixels = rectHeader.width * rectHeader.height;
+		if(numPixels == 0)
+			return true;
+
+		if(!need(BYTES_PER_PIXEL)) return false;
+
+		// convert all buffered whole pixels, continuing at pixel rectProgress:
+		const size_t end = std::min(numPixels, rectProgress + rxAvailable() / BYTES_PER_PIXEL);
+		const uint8_t* src = rxData + rxPos;
+		Pixel *const fb = reinterpret_cast<Pixel*>(pixelData.data());
+		while(rectProgress < end) {
+			const size_t y = rectProgress / rectHeader.width;
+			const size_t x = rectProgress % rectHeader.width;
+			const size_t len = std::min<size_t>(rectHeader.width - x, end - rectProgress); // rest of this row
+
+			Format::convert(src, fb + (rectHeader.pos_y + y) * fb_width + rectHeader.pos_x + x, len);
+
+			src += len * BYTES_PER_PIXEL;
+			consume(len * BYTES_PER_PIXEL);
+			rectProgress += len;
+		}
+
+		return rectProgress == numPixels;
+	}
+
+	// pixel at an offset from the current parse position, converted for the framebuffer
+	template<typename Format>
+	inline typename Format::Pixel rxPixel(const size_t offset) const {
+		return Format::read(rxData + rxPos + offset);
+	}
+
+	// solid rectangle, written row by row (std::fill_n compiles to vector stores)
+	template<typename Pixel>
+	inline void fillRect(const size_t posX, const size_t posY, const size_t width, const size_t height, const Pixel color) {
+		Pixel* row = reinterpret_cast<Pixel*>(pixelData.data()) + posY * fb_width + posX;
+		for(size_t y = 0; y < height; y++, row += fb_width)
+			std::fill_n(row, width, color);
+	}
+
+	// RRE / CoRRE subrectangle, relative to the rect
+	struct Subrect {
+		uint32_t color;
+		uint16_t pos_x, pos_y, width, height;
+	};
+
+	static constexpr size_t SUBRECT_BAND_HEIGHT = 64; // rows painted together; a band of a 4K framebuffer (1 MB) stays in cache
+	std::vector<Subrect> subrects; // reused between rects
+	std::vector<uint32_t> subrectOrder; // per band, in order of arrival
+	std::vector<uint32_t> subrectBandStart; // per band: first entry of subrectOrder
+	size_t rreSubrectsLeft = 0; // of the current rect
+	uint32_t rreBackground = 0;
+
+	// RRE (16 bit subrect coordinates) and CoRRE (8 bit, rects of at most 255x255); subrects are collected as they arrive, painted once all are in
+	template<typename Format>
+	inline bool recvUpdateRectRRE(const RectHeader& rectHeader, const bool compact) {
+		using Pixel = typename Format::Pixel;
+		const size_t BYTES_PER_PIXEL = Format::SIZE;
+		const size_t subrectSize = BYTES_PER_PIXEL + (compact ? 4 : 8);
+
+		if(rectProgress == 0) { // number of subrects, background
+			if(!need(4 + BYTES_PER_PIXEL)) return false;
+			rreSubrectsLeft = rxU32();
+			if(rreSubrectsLeft > size_t(rectHeader.width) * rectHeader.height) // more than one per pixel: corrupt (and would be collected in memory)
+				throw std::runtime_error("RRE: " + std::to_string(rreSubrectsLeft) + " subrects in a rect of "
+					+ std::to_string(rectHeader.width) + "x" + std::to_string(rectHeader.height) + " pixels");
+			rreBackground = rxPixel<Format>(4);
+			consume(4 + BYTES_PER_PIXEL);
+			subrects.clear();
+			rectProgress = 1;
+		}
+
+		while(rreSubrectsLeft > 0) { // all whole subrects buffered so far
+			if(!need(subrectSize)) return false;
+			const size_t count = std::min(rreSubrectsLeft, rxAvailable() / subrectSize);
+			for(size_t i = 0, offset = 0; i < count; i++, offset += subrectSize) {
+				Subrect subrect;
+				subrect.color = rxPixel<Format>(offset);
+				if(compact) {
+					subrect.pos_x  = rxU8(offset + BYTES_PER_PIXEL);
+					subrect.pos_y  = rxU8(offset + BYTES_PER_PIXEL + 1);
+					subrect.width  = rxU8(offset + BYTES_PER_PIXEL + 2);
+					subrect.height = rxU8(offset + BYTES_PER_PIXEL + 3);
+				} else {
+					subrect.pos_x  = rxU16(offset + BYTES_PER_PIXEL);
+					subrect.pos_y  = rxU16(offset + BYTES_PER_PIXEL + 2);
+					subrect.width  = rxU16(offset + BYTES_PER_PIXEL + 4);
+					subrect.height = rxU16(offset + BYTES_PER_PIXEL + 6);
+				}
+
+				if(subrect.pos_x >= rectHeader.width || subrect.pos_y >= rectHeader.height)
+					continue; // clip to the rect
+				subrect.width  = std::min<size_t>(subrect.width,  rectHeader.width  - subrect.pos_x);
+				subrect.height = std::min<size_t>(subrect.height, rectHeader.height - subrect.pos_y);
+				if(subrect.width > 0 && subrect.height > 0)
+					subrects.push_back(subrect);
+			}
+			consume(count * subrectSize);
+			rreSubrectsLeft -= count;
+		}
+
+		fillSubrects<Pixel>(rectHeader, static_cast<Pixel>(rreBackground));
+		return true;
+	}
+
+	/**
+	 * Paints background and subrects band by band, top to bottom: the subrects are bucketed by the bands they overlap,
+	 * so a flood of small subrects in arbitrary order does not walk the whole framebuffer over and over.
+	 * Within a band, subrects are painted in the order they were received (later ones win where they overlap).
+	*/
+	template<typename Pixel>
+	inline void fillSubrects(const RectHeader& rectHeader, const Pixel background) {
+		const size_t numBands = (rectHeader.height + SUBRECT_BAND_HEIGHT - 1) / SUBRECT_BAND_HEIGHT;
+		const auto firstBand = [](const Subrect& subrect) { return subrect.pos_y / SUBRECT_BAND_HEIGHT; };
+		const auto lastBand = [](const Subrect& subrect) { return (subrect.pos_y + subrect.height - 1) / SUBRECT_BAND_HEIGHT; };
+
+		// counting sort into bands (linear, keeps the order of arrival):
+		subrectBandStart.assign(numBands + 1, 0);
+		for(const Subrect& subrect : subrects)
+			for(size_t band = firstBand(subrect); band <= lastBand(subrect); band++)
+				subrectBandStart[band + 1]++;
+		for(size_t band = 0; band < numBands; band++)
+			subrectBandStart[band + 1] += subrectBandStart[band];
+		subrectOrder.resize(subrectBandStart[numBands]);
+		for(size_t i = 0; i < subrects.size(); i++)
+			for(size_t band = firstBand(subrects[i]); band <= lastBand(subrects[i]); band++)
+				subrectOrder[subrectBandStart[band]++] = i;
+		// (subrectBandStart[band] now is the end of band, i.e. the start of band + 1)
+
+		Pixel *const fb = reinterpret_cast<Pixel*>(pixelData.data());
+		size_t next = 0;
+		for(size_t band = 0; band < numBands; band++) {
+			const size_t y0 = band * SUBRECT_BAND_HEIGHT;
+			const size_t y1 = std::min<size_t>(y0 + SUBRECT_BAND_HEIGHT, rectHeader.height);
+			fillRect<Pixel>(rectHeader.pos_x, rectHeader.pos_y + y0, rectHeader.width, y1 - y0, background);
+
+			for(; next < subrectBandStart[band]; next++) {
+				const Subrect& subrect = subrects[subrectOrder[next]];
+				const size_t subY0 = std::max<size_t>(subrect.pos_y, y0);
+				const size_t subY1 = std::min<size_t>(subrect.pos_y + subrect.height, y1);
+
+				Pixel* row = fb + (rectHeader.pos_y + subY0) * fb_width + rectHeader.pos_x + subrect.pos_x;
+				for(size_t y = subY0; y < subY1; y++, row += fb_width)
+					std::fill_n(row, subrect.width, static_cast<Pixel>(subrect.color));
+			}
+		}
+	}
+
+	// Hextile subencoding flags:
+	static constexpr uint8_t HEXTILE_RAW                  = 1 << 0;
+	static constexpr uint8_t HEXTILE_BACKGROUND_SPECIFIED = 1 << 1;
+	static constexpr uint8_t HEXTILE_FOREGROUND_SPECIFIED = 1 << 2;
+	static constexpr uint8_t HEXTILE_ANY_SUBRECTS         = 1 << 3;
+	static constexpr uint8_t HEXTILE_SUBRECTS_COLOURED    = 1 << 4;
+
+	uint32_t hextileBackground = 0; // carried from tile to tile
+	uint32_t hextileForeground = 0;
+
+	// resumes tile by tile: a tile is decoded once it is buffered completely
+	template<typename Format>
+	inline bool recvUpdateRectHEXTILE(const RectHeader& rectHeader) {
+		using Pixel = typename Format::Pixel;
+		const size_t BYTES_PER_PIXEL = Format::SIZE;
+		constexpr size_t TILE_SIZE = 16;
+
+		const size_t numTilesX = (rectHeader.width + TILE_SIZE - 1) / TILE_SIZE;
+		const size_t numTiles = numTilesX * ((rectHeader.height + TILE_SIZE - 1) / TILE_SIZE);
+
+		while(rectProgress < numTiles) {
+			const size_t tileX = rectHeader.pos_x + rectProgress % numTilesX * TILE_SIZE;
+			const size_t tileY = rectHeader.pos_y + rectProgress / numTilesX * TILE_SIZE;
+			const size_t width  = std::min<size_t>(rectHeader.pos_x + rectHeader.width  - tileX, TILE_SIZE);
+			const size_t height = std::min<size_t>(rectHeader.pos_y + rectHeader.height - tileY, TILE_SIZE);
+
+			// size of the tile:
+			if(!need(1)) return false;
+			const uint8_t subencoding = rxU8();
+
+			size_t tileBytes = 1;
+			if(subencoding & HEXTILE_RAW) {
+				tileBytes += width * height * BYTES_PER_PIXEL;
+			} else {
+				if(subencoding & HEXTILE_BACKGROUND_SPECIFIED) tileBytes += BYTES_PER_PIXEL;
+				if(subencoding & HEXTILE_FOREGROUND_SPECIFIED) tileBytes += BYTES_PER_PIXEL;
+				if(subencoding & HEXTILE_ANY_SUBRECTS) {
+					if(!need(tileBytes + 1)) return false;
+					const size_t numSubrects = rxU8(tileBytes);
+					tileBytes += 1 + numSubrects * ((subencoding & HEXTILE_SUBRECTS_COLOURED) ? BYTES_PER_PIXEL + 2 : 2);
+				}
+			}
+			if(!need(tileBytes)) return false;
+
+			// decode:
+			if(subencoding & HEXTILE_RAW) {
+				const uint8_t* src = rxData + rxPos + 1;
+				for(size_t y = 0; y < height; y++, src += width * BYTES_PER_PIXEL)
+					Format::convert(src, reinterpret_cast<Pixel*>(pixelData.data()) + (tileY + y) * fb_width + tileX, width);
+			} else {
+				size_t offset = 1;
+				if(subencoding & HEXTILE_BACKGROUND_SPECIFIED) {
+					hextileBackground = rxPixel<Format>(offset);
+					offset += BYTES_PER_PIXEL;
+				}
+				if(subencoding & HEXTILE_FOREGROUND_SPECIFIED) {
+					hextileForeground = rxPixel<Format>(offset);
+					offset += BYTES_PER_PIXEL;
+				}
+
+				fillRect<Pixel>(tileX, tileY, width, height, hextileBackground);
+
+				if(subencoding & HEXTILE_ANY_SUBRECTS) {
+					const size_t numSubrects = rxU8(offset);
+					offset++;
+
+					for(size_t i = 0; i < numSubrects; i++) {
+						uint32_t color = hextileForeground;
+						if(subencoding & HEXTILE_SUBRECTS_COLOURED) {
+							color = rxPixel<Format>(offset);
+							offset += BYTES_PER_PIXEL;
+						}
+
+						const uint8_t xy = rxU8(offset);
+						const uint8_t wh = rxU8(offset + 1);
+						offset += 2;
+
+						const size_t subX = xy >> 4;
+						const size_t subY = xy & 0x0F;
+						if(subX >= width || subY >= height)
+							continue; // outside of a partial tile
+						fillRect<Pixel>(tileX + subX, tileY + subY, std::min<size_t>((wh >> 4) + 1, width - subX), std::min<size_t>((wh & 0x0F) + 1, height - subY), color);
+					}
+				}
+			}
+
+			consume(tileBytes);
+			rectProgress++;
+		}
+
+		return true;
+	}
+
+	template<typename Format>
+	inline bool recvUpdateRectCOPYRECT(const RectHeader& rectHeader) {
+		const size_t BYTES_PER_PIXEL = sizeof(typename Format::Pixel); // of the framebuffer
+
+		if(!need(4)) return false;
+		const uint16_t srcX0 = rxU16(0);
+		const uint16_t srcY0 = rxU16(2);
+		if(static_cast<size_t>(srcX0) + rectHeader.width > fb_width || static_cast<size_t>(srcY0) + rectHeader.height > fb_height)
+			throw std::runtime_error("CopyRect: source " + std::to_string(rectHeader.width) + "x" + std::to_string(rectHeader.height) + " at " + std::to_string(srcX0) + ", " + std::to_string(srcY0)
+				+ " exceeds the " + std::to_string(fb_width) + "x" + std::to_string(fb_height) + " framebuffer");
+		consume(4);
+
+		std::vector<uint8_t> data(rectHeader.width * rectHeader.height * BYTES_PER_PIXEL);
+		for(size_t y = 0; y < rectHeader.height; y++) {
+			for(size_t x = 0; x < rectHeader.width; x++) {
+				const size_t srcX = srcX0 + x;
+				const size_t srcY = srcY0 + y;
+				const size_t ind_src = (srcY * fb_width + srcX) * BYTES_PER_PIXEL;
+
+				const size_t ind_data = (y * rectHeader.width + x) * BYTES_PER_PIXEL;
+
+				for(size_t i = 0; i < BYTES_PER_PIXEL; i++)
+					data[ind_data + i] = pixelData[ind_src + i];
+			}
+		}
+
+		for(size_t y = 0; y < rectHeader.height; y++) {
+			for(size_t x = 0; x < rectHeader.width; x++) {
+				const size_t dstX = rectHeader.pos_x + x;
+				const size_t dstY = rectHeader.pos_y + y;
+				const size_t ind_dst = (dstY * fb_width + dstX) * BYTES_PER_PIXEL;
+
+				const size_t ind_data = (y * rectHeader.width + x) * BYTES_PER_PIXEL;
+
+				for(size_t i = 0; i < BYTES_PER_PIXEL; i++)
+					pixelData[ind_dst + i] = data[ind_data + i];
+			}
+		}
+
+		return true;
+	}
+
+	uint32_t trlePalette[128] {}; // palette of the previous tile, reused by subencodings 127 and 129
+	size_t trlePaletteSize = 0;
+
+	// resumes tile by tile: a tile is decoded once it is buffered completely
+	template<typename Format>
+	inline bool recvUpdateRectTRLE(const RectHeader& rectHeader) { // tiled run-length encoding
+		constexpr size_t TILE_SIZE = 16;
+
+		const size_t numTilesX = (rectHeader.width + TILE_SIZE - 1) / TILE_SIZE;
+		const size_t numTiles = numTilesX * ((rectHeader.height + TILE_SIZE - 1) / TILE_SIZE);
+
+		while(rectProgress < numTiles) {
+			const size_t tileX = rectHeader.pos_x + rectProgress % numTilesX * TILE_SIZE;
+			const size_t tileY = rectHeader.pos_y + rectProgress / numTilesX * TILE_SIZE;
+			const size_t width  = std::min<size_t>(rectHeader.pos_x + rectHeader.width  - tileX, TILE_SIZE);
+			const size_t height = std::min<size_t>(rectHeader.pos_y + rectHeader.height - tileY, TILE_SIZE);
+
+			size_t tileBytes;
+			while((tileBytes = trleTileSize<Format>(width, height)) == 0)
+				if(!need(rxAvailable() + 1)) return false;
+
+			decodeTRLETile<Format>(rxData + rxPos, tileX, tileY, width, height);
+			consume(tileBytes);
+			rectProgress++;
+		}
+
+		return true;
+	}
+
+	static inline size_t packedPaletteBits(const size_t paletteSize) {
+		return (paletteSize <= 2) ? 1 : (paletteSize <= 4) ? 2 : 4;
+	}
+
+	// size of the buffered tile at the parse position, 0 if it is not buffered completely yet
+	template<typename Format>
+	inline size_t trleTileSize(const size_t width, const size_t height) const {
+		const uint8_t* data = rxData + rxPos;
+		const size_t available = rxAvailable();
+		if(available < 1)
+			return 0;
+
+		const uint8_t subencoding = data[0];
+		size_t size = 1;
+		size_t paletteSize = trlePaletteSize;
+
+		switch(subencoding) {
+			case 0: // raw
+				size += width * height * Format::CPIXEL_SIZE;
+				break;
+
+			case 1: // solid
+				size += Format::CPIXEL_SIZE;
+				break;
+
+			case 127: // packed palette of the previous tile
+				if(paletteSize < 2 || paletteSize > 16)
+					throw std::runtime_error("TRLE: tile reuses a palette of size " + std::to_string(paletteSize) + " for packed pixels");
+				size += height * ((width * packedPaletteBits(paletteSize) + 7) / 8);
+				break;
+
+			case 128: // plain RLE
+				for(size_t pixels = 0; pixels < width * height; ) {
+					size += Format::CPIXEL_SIZE;
+					size_t runLength = 1;
+					do {
+						if(size >= available) return 0;
+						runLength += data[size];
+					} while(data[size++] == 255);
+					pixels += runLength;
+				}
+				break;
+
+			case 129: // palette RLE with the palette of the previous tile
+			default: {
+				if(subencoding >= 2 && subencoding <= 16) { // packed palette
+					size += subencoding * Format::CPIXEL_SIZE + height * ((width * packedPaletteBits(subencoding) + 7) / 8);
+					break;
+				}
+				if(subencoding < 129)
+					throw std::runtime_error("TRLE: invalid tile subencoding " + std::to_string(subencoding));
+
+				if(subencoding > 129) {
+					paletteSize = subencoding - 128;
+					size += paletteSize * Format::CPIXEL_SIZE;
+				}
+				for(size_t pixels = 0; pixels < width * height; ) {
+					if(size >= available) return 0;
+					size_t runLength = 1;
+					if(data[size++] & 0x80) {
+						do {
+							if(size >= available) return 0;
+							runLength += data[size];
+						} while(data[size++] == 255);
+					}
+					pixels += runLength;
+				}
+			} break;
+		}
+
+		return (size <= available) ? size : 0;
+	}
+
+	// writes runLength pixels of one colour, continuing at pixel index pos of the tile (row by row)
+	template<typename Pixel>
+	inline void fillTileRun(const size_t tileX, const size_t tileY, const size_t width, size_t& pos, size_t runLength, const Pixel color, const size_t numPixels) {
+		runLength = std::min(runLength, numPixels - pos); // runs must not leave the tile
+		while(runLength > 0) {
+			const size_t x = pos % width;
+			const size_t len = std::min(runLength, width - x);
+			std::fill_n(reinterpret_cast<Pixel*>(pixelData.data()) + (tileY + pos / width) * fb_width + tileX + x, len, color);
+			pos += len;
+			runLength -= len;
+		}
+	}
+
+	// src holds the complete tile (checked by trleTileSize())
+	template<typename Format>
+	inline void decodeTRLETile(const uint8_t* src, const size_t tileX, const size_t tileY, const size_t width, const size_t height) {
+		using Pixel = typename Format::Pixel;
+		Pixel *const fb = reinterpret_cast<Pixel*>(pixelData.data());
+		const size_t numPixels = width * height;
+
+		const uint8_t subencoding = *src++;
+		const auto readPalette = [&](const size_t paletteSize) {
+			trlePaletteSize = paletteSize;
+			for(size_t i = 0; i < paletteSize; i++, src += Format::CPIXEL_SIZE)
+				trlePalette[i] = Format::readCPixel(src);
+		};
+		const auto readRunLength = [&]() {
+			size_t runLength = 1;
+			do {
+				runLength += *src;
+			} while(*src++ == 255);
+			return runLength;
+		};
+
+		if(subencoding == 0) { // raw
+			for(size_t y = 0; y < height; y++) {
+				Pixel *const row = fb + (tileY + y) * fb_width + tileX;
+				for(size_t x = 0; x < width; x++, src += Format::CPIXEL_SIZE)
+					row[x] = Format::readCPixel(src);
+			}
+		} else if(subencoding == 1) { // solid
+			fillRect<Pixel>(tileX, tileY, width, height, Format::readCPixel(src));
+		} else if(subencoding <= 16 || subencoding == 127) { // packed palette
+			if(subencoding != 127)
+				readPalette(subencoding);
+
+			const size_t bitsPerPixel = packedPaletteBits(trlePaletteSize);
+			const uint8_t mask = (1 << bitsPerPixel) - 1;
+			for(size_t y = 0; y < height; y++) {
+				Pixel *const row = fb + (tileY + y) * fb_width + tileX;
+				size_t bitOff = 8;
+				for(size_t x = 0; x < width; x++) { // rows start at byte boundaries, pixels are packed msb first
+					if(bitOff == 0) {
+						src++;
+						bitOff = 8;
+					}
+					bitOff -= bitsPerPixel;
+					row[x] = trlePalette[(*src >> bitOff) & mask];
+				}
+				src++;
+			}
+		} else if(subencoding == 128) { // plain RLE
+			for(size_t pos = 0; pos < numPixels; ) {
+				const Pixel color = Format::readCPixel(src);
+				src += Format::CPIXEL_SIZE;
+				fillTileRun<Pixel>(tileX, tileY, width, pos, readRunLength(), color, numPixels);
+			}
+		} else { // palette RLE
+			if(subencoding != 129)
+				readPalette(subencoding - 128);
+
+			for(size_t pos = 0; pos < numPixels; ) {
+				const uint8_t index = *src++;
+				const size_t runLength = (index & 0x80) ? readRunLength() : 1;
+				fillTileRun<Pixel>(tileX, tileY, width, pos, runLength, trlePalette[index & 0x7F], numPixels);
+			}
+		}
+	}
+
+
+	ZlibStream zlibStream; // persistent per connection, separate from the one of ZRLE
+
+	// RAW pixels in a zlib stream, inflated straight into the rows of the rect (or converted row by row from the inflated data)
+	template<typename Format>
+	inline bool recvUpdateRectZLIB(const RectHeader& rectHeader) {
+		using Pixel = typename Format::Pixel;
+		if(!need(4)) return false;
+		const uint32_t zlibLength = rxU32();
+		if(!need(4 + zlibLength)) return false;
+
+		const size_t rowBytes = rectHeader.width * Format::SIZE;
+		Pixel *const dst = reinterpret_cast<Pixel*>(pixelData.data()) + rectHeader.pos_y * fb_width + rectHeader.pos_x;
+		size_t written;
+		if constexpr(Format::DIRECT) {
+			written = zlibStream.inflateRows(rxData + rxPos + 4, zlibLength, reinterpret_cast<uint8_t*>(dst), rowBytes, fb_width * sizeof(Pixel), rectHeader.height);
+		} else {
+			const ZlibStream::Output inflated = zlibStream.inflate(rxData + rxPos + 4, zlibLength);
+			written = inflated.second;
+			if(written == rowBytes * rectHeader.height)
+				for(size_t y = 0; y < rectHeader.height; y++)
+					Format::convert(inflated.first + y * rowBytes, dst + y * fb_width, rectHeader.width);
+		}
+		consume(4 + zlibLength);
+
+		if(written != rowBytes * rectHeader.height)
+			throw std::runtime_error("Error: Zlib rect with " + std::to_string(written) + " bytes of pixel data for " + std::to_string(rectHeader.width) + "x" + std::to_string(rectHeader.height) + " pixels");
+		return true;
+	}
+
+
+	ZlibStream zrleStream; // one zlib stream per connection (shared by ZRLE and ZYWRLE)
+	size_t zrleLeft = 0; // zlib data of the current rect that was not inflated yet
+	Zywrle zywrle;
+
+	// wavelet levels of ZYWRLE for the announced quality level, as the server derives them (libvncserver)
+	inline size_t zywrleLevel() const {
+		if(qualityLevel < 0) return 1;
+		if(qualityLevel < 3) return 3;
+		if(qualityLevel < 6) return 2;
+		return 1;
+	}
+
+	// tiled run-length encoding; ZYWRLE (waveletLevel > 0) sends the wavelet coefficients of tiles as ZRLE pixels
+	template<typename Format>
+	inline bool recvUpdateRectZRLE(const RectHeader& rectHeader, const size_t waveletLevel = 0) {
+		using Pixel = typename Format::Pixel;
+		if(!std::is_same_v<Format, FormatBGRX32> && waveletLevel > 0)
+			throw std::runtime_error("ZYWRLE: wavelet tiles are only supported for 32 bit true colour");
+
+
+		if(rectProgress == 0) { // length of the zlib data
+			if(!need(4)) return false;
+			zrleLeft = rxU32();
+			consume(4);
+			zrleStream.beginPiece();
+			rectProgress = 1;
+		}
+
+		// inflate block by block while the zlib data arrives, straight out of the receive buffer (only an incomplete block is kept):
+		while(zrleLeft > 0) {
+			const size_t available = std::min(rxAvailable(), zrleLeft);
+			const size_t used = zrleStream.inflatePart(rxData + rxPos, available, available == zrleLeft);
+			consume(used);
+			zrleLeft -= used;
+			if(zrleLeft > 0 && !need(rxAvailable() + 1)) return false;
+		}
+
+		// the tiles are parsed once the whole rect is inflated:
+		const ZlibStream::Output inflated = zrleStream.pieceOutput();
+		const uint8_t *const rawData = inflated.first;
+		const size_t rawLength = inflated.second;
+
+		size_t dataInd = 0;
+
+		const auto recvU8 =
+			[&]() -> uint8_t  {
+				if(dataInd >= rawLength)
+					throw std::runtime_error("Out of uncompressed zlib data!");
+				const uint8_t val = rawData[dataInd]; dataInd++; return val;
+			};
+		const auto recvCPixel =
+			[&]() -> uint32_t {
+				if(dataInd + Format::CPIXEL_SIZE > rawLength)
+					throw std::runtime_error("Out of uncompressed zlib data!");
+				const uint32_t val = Format::readCPixel(rawData + dataInd); dataInd += Format::CPIXEL_SIZE; return val;
+			};
+		Pixel *const fb = reinterpret_cast<Pixel*>(pixelData.data());
+		
+		constexpr size_t TILE_SIZE = 64;
+		const size_t numTilesX = rectHeader.width / TILE_SIZE + !!(rectHeader.width % TILE_SIZE);
+		const size_t numTilesY = rectHeader.height / TILE_SIZE + !!(rectHeader.height % TILE_SIZE);
+
+		struct {
+			size_t paletteSize;
+			uint32_t palette[16];
+		} packedPallette;
+
+		struct {
+			size_t paletteSize;
+			uint32_t palette[128]; // (indices have 7 bits)
+		} rlePallette;
+
+		for(size_t tileY = 0; tileY < numTilesY; tileY++) {
+			for(size_t tileX = 0; tileX < numTilesX; tileX++) {
+				uint8_t subEncoding = recvU8();
+
+				// ZYWRLE: a raw tile header announces a transformed tile, which follows as a complete tile of its own
+				const bool transformed = waveletLevel > 0 && subEncoding == 0;
+				if(transformed)
+					subEncoding = recvU8();
+
+				const size_t width  = std::min<size_t>(rectHeader.width  - tileX * TILE_SIZE, TILE_SIZE);
+				const size_t height = std::min<size_t>(rectHeader.height - tileY * TILE_SIZE, TILE_SIZE);
+
+				switch(subEncoding) {
+				case 0: { // raw
+					for(size_t localY = 0; localY < height; localY++) {
+						for(size_t localX = 0; localX < width; localX++) {
+							const size_t absX = rectHeader.pos_x + tileX * TILE_SIZE + localX;
+							const size_t absY = rectHeader.pos_y + tileY * TILE_SIZE + localY;
+
+							fb[absY * fb_width + absX] = recvCPixel();
+						}
+					}
+				} break;
+				
+				case 1: { // solid color
+					// std::cout << " - Solid color\n";
+					
+					const Pixel col = recvCPixel();
+
+					for(size_t localY = 0; localY < height; localY++) {
+						for(size_t localX = 0; localX < width; localX++) {
+							const size_t absX = rectHeader.pos_x + tileX * TILE_SIZE + localX;
+							const size_t absY = rectHeader.pos_y + tileY * TILE_SIZE + localY;
+
+							fb[absY * fb_width + absX] = col;
+						}
+					}
+				} break;
+				
+				// packed palette
+				case 2:
+				case 3:
+				case 4:
+				case 5:
+				case 6:
+				case 7:
+				case 8:
+				case 9:
+				case 10:
+				case 11:
+				case 12:
+				case 13:
+				case 14:
+				case 15:
+				case 16: {
+					// std::cout << " - Packed palette\n";
+					packedPallette.paletteSize = subEncoding;
+
+					// receive palette:
+					for(size_t i = 0; i < packedPallette.paletteSize; i++)
+						packedPallette.palette[i] = recvCPixel();
+				
+				// case 127: // reuse palette of the previous tile (not valid for ZRLE)
+					const size_t bitsPerPixel =
+						(packedPallette.paletteSize == 2)                                    ? 1 : // paletteSize == 2
+						(packedPallette.paletteSize == 3 || packedPallette.paletteSize == 4) ? 2 : // 3 <= paletteSize <= 4
+						                                                                       4;  // 5 <= paletteSize <= 16
+					const size_t pixelsPerByte = 8 / bitsPerPixel;
+
+					const size_t bytesX = (width + pixelsPerByte - 1) / pixelsPerByte;
+					
+					// receive packed pixels:
+					for(size_t localY = 0; localY < height; localY++) {
+						for(size_t byteX = 0; byteX < bytesX; byteX++) {
+							const uint8_t byte = recvU8();
+							const size_t pixelsInThisByte = std::min<size_t>(width - (byteX * pixelsPerByte), pixelsPerByte);
+
+							for(size_t pixelSubIndex = 0; pixelSubIndex < pixelsInThisByte; pixelSubIndex++) { // iterate over all pixels packed into the current byte
+								const uint8_t bitOff = 8 - (pixelSubIndex + 1) * bitsPerPixel; // bits are packed left -> right : msb -> lsb (a partial last byte is padded at the lsb end)
+								const uint8_t mask = (0x01 << bitsPerPixel) - 1;
+								const uint8_t pixel = (byte >> bitOff) & mask; // extract index into palette
+
+								const size_t absX = rectHeader.pos_x + tileX * TILE_SIZE + (byteX * pixelsPerByte + pixelSubIndex);
+								const size_t absY = rectHeader.pos_y + tileY * TILE_SIZE + localY;
+
+								fb[absY * fb_width + absX] = packedPallette.palette[pixel];
+							}
+						}
+					}
+				} break;
+
+				case 128: { // plain RLE (run-length encoding)
+					// std::cout << " - Plain RLE\n";
+					const auto getRunLength = [&]() -> size_t {
+							size_t runLength = 0;
+							uint8_t byte = 0;
+							do {
+								byte = recvU8();
+								runLength += byte;
+							} while(byte == 255);
+							return runLength + 1;
+						};
+
+					size_t runLength = 0;
+					uint32_t pixelValue;
+
+					for(size_t localY = 0; localY < height; localY++) {
+						for(size_t localX = 0; localX < width; localX++) {
+							const size_t absX = rectHeader.pos_x + tileX * TILE_SIZE + localX;
+							const size_t absY = rectHeader.pos_y + tileY * TILE_SIZE + localY;
+
+							if(runLength == 0) {
+								pixelValue = recvCPixel();
+								runLength = getRunLength();
+							}
+
+							fb[absY * fb_width + absX] = pixelValue;
+
+							runLength--;
+						}
+					}
+				} break;
+
+				//  Palette RLE
+				case 130: case 131: case 132: case 133: case 134: case 135: case 136: case 137: case 138: case 139:
+				case 140: case 141: case 142: case 143: case 144: case 145: case 146: case 147: case 148: case 149:
+				case 150: case 151: case 152: case 153: case 154: case 155: case 156: case 157: case 158: case 159:
+				case 160: case 161: case 162: case 163: case 164: case 165: case 166: case 167: case 168: case 169:
+				case 170: case 171: case 172: case 173: case 174: case 175: case 176: case 177: case 178: case 179:
+				case 180: case 181: case 182: case 183: case 184: case 185: case 186: case 187: case 188: case 189:
+				case 190: case 191: case 192: case 193: case 194: case 195: case 196: case 197: case 198: case 199:
+				case 200: case 201: case 202: case 203: case 204: case 205: case 206: case 207: case 208: case 209:
+				case 210: case 211: case 212: case 213: case 214: case 215: case 216: case 217: case 218: case 219:
+				case 220: case 221: case 222: case 223: case 224: case 225: case 226: case 227: case 228: case 229:
+				case 230: case 231: case 232: case 233: case 234: case 235: case 236: case 237: case 238: case 239:
+				case 240: case 241: case 242: case 243: case 244: case 245: case 246: case 247: case 248: case 249:
+				case 250: case 251: case 252: case 253: case 254: case 255: {
+					// std::cout << " - Palette RLE\n";
+					rlePallette.paletteSize = subEncoding - 128;
+
+					for(size_t i = 0; i < rlePallette.paletteSize; i++)
+						rlePallette.palette[i] = recvCPixel();
+
+				// case 129: // Palette RLE using previous palette (not valid for ZRLE)
+					const auto getRunLength = [&]() -> size_t {
+							size_t runLength = 0;
+							uint8_t byte = 0;
+							do {
+								byte = recvU8();
+								runLength += byte;
+							} while(byte == 255);
+							return runLength + 1;
+						};
+
+					size_t runLength = 0;
+					uint8_t paletteIndex;
+
+					for(size_t localY = 0; localY < height; localY++) {
+						for(size_t localX = 0; localX < width; localX++) {
+							const size_t absX = rectHeader.pos_x + tileX * TILE_SIZE + localX;
+							const size_t absY = rectHeader.pos_y + tileY * TILE_SIZE + localY;
+
+							if(runLength == 0) {
+								const uint8_t rawIndex = recvU8();
+
+								paletteIndex = rawIndex & 0x7F;
+								if(paletteIndex >= rlePallette.paletteSize)
+									throw std::runtime_error("ZRLE: palette index " + std::to_string(paletteIndex) + " out of range");
+								runLength = 1;
+
+								if(rawIndex & 0x80)
+									runLength = getRunLength();
+							}
+
+							fb[absY * fb_width + absX] = rlePallette.palette[paletteIndex];
+
+							runLength--;
+						}
+					}
+				} break;
+
+				default: // 17 - 126 are unused; 127 and 129 reuse the palette of the previous tile (not valid for ZRLE)
+					throw std::runtime_error("ZRLE: invalid tile subencoding " + std::to_string(subEncoding));
+				}
+
+				if(transformed) {
+					uint32_t *const tile = reinterpret_cast<uint32_t*>(pixelData.data()) + (rectHeader.pos_y + tileY * TILE_SIZE) * fb_width + rectHeader.pos_x + tileX * TILE_SIZE;
+					zywrle.synthesize(tile, fb_width, width, height, waveletLevel);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// Tight compression control (first byte of a rect); the low nibble resets zlib streams, the high nibble selects the subencoding:
+	static constexpr uint8_t TIGHT_FILL = 0x08;
+	static constexpr uint8_t TIGHT_JPEG = 0x09;
+	static constexpr uint8_t TIGHT_EXPLICIT_FILTER = 0x04; // basic compression: a filter id follows
+	// Tight filters:
+	static constexpr uint8_t TIGHT_FILTER_COPY     = 0;
+	static constexpr uint8_t TIGHT_FILTER_PALETTE  = 1;
+	static constexpr uint8_t TIGHT_FILTER_GRADIENT = 2;
+	static constexpr size_t TIGHT_MIN_TO_COMPRESS = 12; // smaller data is sent without zlib
+
+	ZlibStream tightStreams[4]; // persistent per connection, reset on request of the server
+	uint32_t tightPalette[256] {};
+	std::vector<uint8_t> tightRows; // two rows of colour components for the gradient filter
+	jpeg::Decoder tightJpeg; // keeps its buffers between rects
+
+	// 1 to 3 bytes, 7 bits each (least significant first), the third byte contributes all 8 bits; false if not buffered yet
+	inline bool rxCompactLength(size_t& offset, size_t& length) {
+		length = 0;
+		for(size_t i = 0; i < 3; i++) {
+			if(!need(offset + 1)) return false;
+			const uint8_t byte = rxU8(offset++);
+			length |= static_cast<size_t>((i < 2) ? byte & 0x7F : byte) << (7 * i);
+			if(!(byte & 0x80)) break;
+		}
+		return true;
+	}
+
+	// the rect is buffered completely first (its zlib data only has a length prefix)
+	template<typename Format>
+	inline bool recvUpdateRectTIGHT(const RectHeader& rectHeader) {
+		using Pixel = typename Format::Pixel;
+		if(!need(1)) return false;
+		const uint8_t control = rxU8();
+		const uint8_t compression = control >> 4;
+		size_t offset = 1;
+
+		if(compression > TIGHT_JPEG)
+			throw std::runtime_error("Tight: invalid compression control " + std::to_string(control));
+
+		if(compression == TIGHT_FILL) {
+			if(!need(offset + Format::TPIXEL_SIZE)) return false;
+			resetTightStreams(control);
+			fillRect<Pixel>(rectHeader.pos_x, rectHeader.pos_y, rectHeader.width, rectHeader.height, Format::readTPixel(rxData + rxPos + offset));
+			consume(offset + Format::TPIXEL_SIZE);
+			return true;
+		}
+
+		if(compression == TIGHT_JPEG) { // baseline JFIF image of the rect's size
+			if(!Format::TRUE_COLOR)
+				throw std::runtime_error("Tight: JPEG rect without true colour");
+			size_t length;
+			if(!rxCompactLength(offset, length) || !need(offset + length)) return false;
+			resetTightStreams(control);
+			uint32_t *const dst = reinterpret_cast<uint32_t*>(pixelData.data()) + rectHeader.pos_y * fb_width + rectHeader.pos_x;
+			tightJpeg.decode(rxData + rxPos + offset, length, dst, fb_width, rectHeader.width, rectHeader.height);
+			consume(offset + length);
+			return true;
+		}
+
+		// basic compression:
+		uint8_t filter = TIGHT_FILTER_COPY;
+		if(compression & TIGHT_EXPLICIT_FILTER) {
+			if(!need(offset + 1)) return false;
+			filter = rxU8(offset++);
+		}
+
+		size_t numColors = 0;
+		size_t paletteOffset = 0;
+		size_t dataSize = rectHeader.width * rectHeader.height * Format::TPIXEL_SIZE;
+		if(filter == TIGHT_FILTER_PALETTE) {
+			if(!need(offset + 1)) return false;
+			numColors = rxU8(offset++) + 1;
+			if(!need(offset + numColors * Format::TPIXEL_SIZE)) return false;
+			paletteOffset = offset;
+			offset += numColors * Format::TPIXEL_SIZE;
+			dataSize = (numColors == 2) ? rectHeader.height * ((rectHeader.width + 7) / 8) : rectHeader.width * rectHeader.height;
+		} else if(filter != TIGHT_FILTER_COPY && filter != TIGHT_FILTER_GRADIENT) {
+			throw std::runtime_error("Tight: invalid filter " + std::to_string(filter));
+		} else if(filter == TIGHT_FILTER_GRADIENT && !Format::TRUE_COLOR) {
+			throw std::runtime_error("Tight: gradient filter without true colour");
+		}
+
+		size_t payloadSize = dataSize;
+		if(dataSize >= TIGHT_MIN_TO_COMPRESS && !rxCompactLength(offset, payloadSize)) return false;
+		if(!need(offset + payloadSize)) return false;
+
+		// complete:
+		resetTightStreams(control);
+		for(size_t i = 0; i < numColors; i++)
+			tightPalette[i] = Format::readTPixel(rxData + rxPos + paletteOffset + i * Format::TPIXEL_SIZE);
+
+		const uint8_t* data = rxData + rxPos + offset;
+		if(dataSize >= TIGHT_MIN_TO_COMPRESS) {
+			const ZlibStream::Output inflated = tightStreams[compression & 0x03].inflate(data, payloadSize);
+			if(inflated.second < dataSize)
+				throw std::runtime_error("Tight: out of uncompressed zlib data");
+			data = inflated.first;
+		}
+
+		Pixel* row = reinterpret_cast<Pixel*>(pixelData.data()) + rectHeader.pos_y * fb_width + rectHeader.pos_x;
+		const size_t width = rectHeader.width;
+		if(filter == TIGHT_FILTER_COPY && Format::TPIXEL_SIZE == Format::SIZE) { // whole pixels
+			for(size_t y = 0; y < rectHeader.height; y++, row += fb_width, data += width * Format::SIZE)
+				Format::convert(data, row, width);
+		} else if(filter == TIGHT_FILTER_COPY) {
+			for(size_t y = 0; y < rectHeader.height; y++, row += fb_width)
+				for(size_t x = 0; x < width; x++, data += Format::TPIXEL_SIZE)
+					row[x] = Format::readTPixel(data);
+		} else if(filter == TIGHT_FILTER_PALETTE && numColors == 2) { // 1 bit per pixel, msb first, rows start at byte boundaries
+			for(size_t y = 0; y < rectHeader.height; y++, row += fb_width, data += (width + 7) / 8)
+				for(size_t x = 0; x < width; x++)
+					row[x] = tightPalette[(data[x / 8] >> (7 - x % 8)) & 0x01];
+		} else if(filter == TIGHT_FILTER_PALETTE) {
+			for(size_t y = 0; y < rectHeader.height; y++, row += fb_width)
+				for(size_t x = 0; x < width; x++)
+					row[x] = tightPalette[*data++];
+		} else if constexpr(Format::TRUE_COLOR) {
+			decodeTightGradient<Format>(data, row, width, rectHeader.height);
+		}
+
+		consume(offset + payloadSize);
+		return true;
+	}
+
+	// each colour component is predicted by left + above - above left, clamped to 0 .. max; the data holds the differences
+	template<typename Format>
+	inline void decodeTightGradient(const uint8_t* data, typename Format::Pixel* row, const size_t width, const size_t height) {
+		constexpr size_t TPIXEL_SIZE = Format::TPIXEL_SIZE;
+		if constexpr(std::is_same_v<Format, FormatBGRX32>) { // red, green, blue bytes: the components are the bytes
+			tightRows.assign(2 * width * TPIXEL_SIZE, 0);
+			uint8_t* above = tightRows.data();
+			uint8_t* current = above + width * TPIXEL_SIZE;
+			for(size_t y = 0; y < height; y++, row += fb_width, std::swap(above, current)) {
+				for(size_t c = 0; c < TPIXEL_SIZE; c++) // first pixel: nothing to the left
+					current[c] = above[c] + data[c];
+				for(size_t i = TPIXEL_SIZE; i < width * TPIXEL_SIZE; i++) {
+					const int prediction = current[i - TPIXEL_SIZE] + above[i] - above[i - TPIXEL_SIZE];
+					current[i] = std::clamp(prediction, 0, 255) + data[i];
+				}
+				for(size_t x = 0; x < width; x++)
+					row[x] = Format::readTPixel(current + x * TPIXEL_SIZE);
+				data += width * TPIXEL_SIZE;
+			}
+		} else { // whole pixels: the components are bit fields (sums wrap around at max + 1)
+			const int maxes[3] = { Format::RED_MAX, Format::GREEN_MAX, Format::BLUE_MAX };
+			const uint8_t shifts[3] = { Format::RED_SHIFT, Format::GREEN_SHIFT, Format::BLUE_SHIFT };
+			tightRows.assign(2 * (width + 1) * 3, 0); // one pixel of zeros left of each row
+			uint8_t* above = tightRows.data();
+			uint8_t* current = above + (width + 1) * 3;
+			for(size_t y = 0; y < height; y++, row += fb_width, std::swap(above, current)) {
+				for(size_t x = 0; x < width; x++, data += TPIXEL_SIZE) {
+					const uint32_t difference = Format::readRaw(data);
+					uint32_t raw = 0;
+					for(size_t c = 0; c < 3; c++) {
+						const size_t i = (x + 1) * 3 + c;
+						const int prediction = std::clamp(current[i - 3] + above[i] - above[i - 3], 0, maxes[c]);
+						current[i] = (prediction + (difference >> shifts[c])) & maxes[c];
+						raw |= static_cast<uint32_t>(current[i]) << shifts[c];
+					}
+					row[x] = Format::fromRaw(raw);
+				}
+			}
+		}
+	}
+
+	inline void resetTightStreams(const uint8_t control) {
+		for(size_t i = 0; i < 4; i++)
+			if(control & (1 << i))
+				tightStreams[i].reset();
+	}
+
+
+public:
+	// ---- utilities ----
+
+	inline void close() const {
+		sock.close();
+	}
+
+	inline auto nativeHandle() const { return sock.nativeHandle(); }
+	inline const Transport& transport() const { return sock; }
+
+	inline double rtt() const { return smoothedRtt; } // 0 until the first requested update arrived
+	inline double updateRate() const { return smoothedUpdateInterval > 0 ? 1. / smoothedUpdateInterval : 0.; } // completed FramebufferUpdates per second
+	inline size_t requestsInFlight() const { return requestTimes.size(); }
+	inline bool continuousUpdates() const { return continuousUpdatesActive; }
+	inline double fenceLatency() const { return smoothedFenceLatency; } // end-to-end, 0 without Fence support
+	inline double bandwidth() const { return bandwidthEstimate; } // received bytes per second between Fence responses
+	inline const std::vector<int32_t>& encodings() const { return pixelEncodings; } // current preference order
+	inline const std::unordered_map<int32_t, EncodingEstimate>& encodingEstimates() const { return estimates; }
+
+	inline bool refreshing() const { return refreshActive; } // progressive refresh running
+	inline bool updatesSuspended() const { return updateMode == UpdateMode::SUSPENDED; }
+	inline bool updatesRestricted() const { return updateMode == UpdateMode::RESTRICTED; }
+	inline double timeToFirstPixels() const { return refreshFirstPixels; } // of the last progressive refresh, in seconds; 0 until known
+	inline double timeToFullFrame() const { return refreshFullFrame; }
+
+	// bytes per second; maximum delivery rate of large updates over the last evaluations (or a guess from the RTT), 0 if unknown
+	inline double linkCapacity() const {
+		if(!deliveryRates.empty())
+			return *std::max_element(deliveryRates.begin(), deliveryRates.end());
+		if(smoothedRtt > 0)
+			return (smoothedRtt < LAN_RTT) ? LAN_CAPACITY : WAN_CAPACITY;
+		return 0;
+	}
+
+	inline uint16_t width() const { return fb_width; }
+	inline uint16_t height() const { return fb_height; }
+	inline uint8_t* pixel_data() { return pixelData.data(); }
+	inline const uint8_t* pixel_data() const { return pixelData.data(); }
+	inline size_t bytesPerPixel() const { return indexedColor() ? 1 : 4; } // of pixel_data()
+	inline bool indexedColor() const { return wireFormat == WireFormat::INDEXED8; } // pixel_data() holds indices into colorMap()
+	inline WireFormat pixelFormat() const { return wireFormat; } // on the wire (see setPixelFormat())
+	inline const std::array<uint32_t, 256>& colorMap() const { return colorMapLUT; } // blue | green << 8 | red << 16
+	inline const CursorShape* cursor() const { return cursorShape.get(); } // to draw at the local pointer position; nullptr: none
+	inline const CursorCache& cursors() const { return cursorCache; }
+	inline const std::vector<Screen>& screens() const { return screenLayout; }
+
+	// called whenever the framebuffer was reallocated (DesktopSize / ExtendedDesktopSize), e.g. to rebuild scaling tables
+	inline void setResizeCallback(std::function<void(uint16_t width, uint16_t height)> callback) {
+		resizeCallback = std::move(callback);
+	}
+};
+
+
+using VNC = BasicVNC<Socket>;
\ No newline at end of file
@@ -0,0 +1,216 @@
+#pragma once
+
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "MemoryTransport.hpp"
+#include "compression/deflate_decompress.h"
+
+
+/**
+ * Receiving end of a zlib stream that is sent in pieces, each ending on a DEFLATE block boundary (as the ZRLE and Tight
+ * encodings do). The last 32 KiB of output are kept between pieces, since later blocks may reference them (LZ77).
+ * inflateRows() writes the output of a piece straight into rows of a destination (a rect of the framebuffer);
+ * inflatePart() decompresses a piece while it is still arriving.
+*/
+class ZlibStream {
+public:
+	using Output = std::pair<const uint8_t*, size_t>;
+
+private:
+	static constexpr size_t WINDOW_SIZE = 32768;
+
+	std::vector<uint8_t> output = std::vector<uint8_t>(WINDOW_SIZE); // window, followed by the output of the latest piece
+	size_t windowSize = WINDOW_SIZE;
+	bool headerPending = true; // the first piece starts with the 2 byte zlib header
+
+	// piece that arrives in parts (inflatePart()):
+	uint8_t partBitOffset = 0; // bits of the first byte of the next part that belong to blocks decompressed already
+	size_t retryLength = 0; // data needed for the next try: a block is only started once about as much arrived as the previous one had,
+	size_t blockLength = 0; // and an incomplete block is tried again once twice as much of it arrived (linear work, even for byte-wise arrival)
+
+	// output sink of the decompressor: stream offsets past the window map to numRows rows of rowBytes bytes, stride bytes apart
+	class RowOutput {
+	private:
+		const std::vector<uint8_t>& window;
+		uint8_t *const dst;
+		const size_t rowBytes;
+		const size_t stride;
+		const size_t capacity;
+
+		size_t written = 0;
+		uint8_t* cursor;
+		uint8_t* rowEnd;
+
+		// row of the latest read (LZ77 matches read forward, mostly within one row)
+		mutable size_t readRowStart = 0;
+		mutable const uint8_t* readRow;
+
+	public:
+		inline RowOutput(const std::vector<uint8_t>& window, uint8_t *const dst, const size_t rowBytes, const size_t stride, const size_t numRows):
+			window(window), dst(dst), rowBytes(rowBytes), stride(stride), capacity(rowBytes * numRows), cursor(dst), rowEnd(dst + rowBytes), readRow(dst) { }
+
+		inline size_t size() const {
+			return window.size() + written;
+		}
+
+		inline void push_back(const uint8_t byte) {
+			if(written == capacity)
+				throw std::runtime_error("ZlibStream::inflateRows(): more output than fits the rows");
+			if(cursor == rowEnd) {
+				cursor += stride - rowBytes;
+				rowEnd = cursor + rowBytes;
+			}
+			*cursor++ = byte;
+			written++;
+		}
+
+		inline uint8_t operator[](const size_t index) const {
+			if(index < window.size())
+				return window[index];
+
+			const size_t offset = index - window.size();
+			if(offset - readRowStart >= rowBytes) { // (wraps around for offsets before the row)
+				readRowStart = offset - offset % rowBytes;
+				readRow = dst + offset / rowBytes * stride;
+			}
+			return readRow[offset - readRowStart];
+		}
+
+		inline size_t numWritten() const {
+			return written;
+		}
+
+		// copies the written bytes from offset on
+		inline void copyTo(size_t offset, uint8_t* out) const {
+			while(offset < written) {
+				const size_t len = std::min(rowBytes - offset % rowBytes, written - offset);
+				memcpy(out, dst + offset / rowBytes * stride + offset % rowBytes, len);
+				out += len;
+				offset += len;
+			}
+		}
+	};
+
+	inline void skipHeader(const uint8_t*& data, size_t& len) {
+		if(headerPending) {
+			if(len < 2) throw std::runtime_error("ZlibStream: missing zlib header");
+			data += 2;
+			len -= 2;
+			headerPending = false;
+		}
+	}
+
+	// slides the window over the output of the previous piece
+	inline void slideWindow() {
+		if(output.size() > WINDOW_SIZE)
+			output.erase(output.begin(), output.end() - WINDOW_SIZE);
+		windowSize = output.size();
+	}
+
+public:
+	// decompresses the next piece; the returned bytes stay valid until the next call
+	inline Output inflate(const uint8_t* data, size_t len) {
+		beginPiece();
+		inflatePart(data, len, true);
+		return pieceOutput();
+	}
+
+	/**
+	 * Decompresses the next piece while it arrives: beginPiece(), then inflatePart() with the received data of the piece that was not
+	 * used yet, until all of it was used (last: the data reaches the end of the piece), then pieceOutput().
+	 * inflatePart() decompresses the complete DEFLATE blocks and returns the number of bytes it used, so the caller only has to keep
+	 * the incomplete block at the end.
+	*/
+	inline void beginPiece() {
+		slideWindow();
+		partBitOffset = 0;
+		retryLength = 0;
+	}
+
+	inline size_t inflatePart(const uint8_t* data, size_t len, const bool last) {
+		size_t used = 0;
+		if(headerPending) {
+			if(len < 2 && !last)
+				return 0;
+			skipHeader(data, len);
+			used = 2;
+		}
+		if(len == 0 || (!last && len < retryLength))
+			return used;
+
+		const MemoryTransport compressed(data, len);
+		ChunkedBitstreamReader<MemoryTransport> streamReader(compressed, len);
+		streamReader.skipBits(partBitOffset);
+
+		size_t blockStart = partBitOffset; // in bits
+		while(!streamReader.isEmpty()) {
+			const size_t left = len - blockStart / 8;
+			if(!last && left < blockLength) {
+				retryLength = blockLength;
+				break;
+			}
+
+			const size_t outputBefore = output.size();
+			try {
+				deflate::decompressBlock(streamReader, output);
+			} catch(const std::runtime_error&) {
+				if(last || !streamReader.outOfData())
+					throw;
+				output.resize(outputBefore); // incomplete block: decompressed again with more data
+				retryLength = 2 * left;
+				break;
+			}
+			if(!last) // (the last block of a piece is usually a short one)
+				blockLength = (streamReader.bitPosition() - blockStart + 7) / 8;
+			blockStart = streamReader.bitPosition();
+		}
+
+		partBitOffset = blockStart % 8;
+		return used + blockStart / 8;
+	}
+
+	// output of the piece; stays valid until the next piece
+	inline Output pieceOutput() const {
+		return Output(output.data() + windowSize, output.size() - windowSize);
+	}
+
+	/**
+	 * Decompresses the next piece into numRows rows of rowBytes bytes, stride bytes apart, without an intermediate buffer;
+	 * throws if the output does not fit. Returns the number of bytes written.
+	*/
+	inline size_t inflateRows(const uint8_t* data, size_t len, uint8_t *const dst, const size_t rowBytes, const size_t stride, const size_t numRows) {
+		skipHeader(data, len);
+		slideWindow();
+
+		RowOutput rows(output, dst, rowBytes, stride, numRows);
+		const MemoryTransport compressed(data, len);
+		ChunkedBitstreamReader<MemoryTransport> streamReader(compressed, len);
+		while(!streamReader.isEmpty())
+			deflate::decompressBlock(streamReader, rows);
+
+		// keep the end of the output as the window of the next piece:
+		const size_t written = rows.numWritten();
+		const size_t keep = std::min(written, WINDOW_SIZE);
+		if(output.size() + keep > WINDOW_SIZE)
+			output.erase(output.begin(), output.begin() + (output.size() + keep - WINDOW_SIZE));
+		const size_t windowEnd = output.size();
+		output.resize(windowEnd + keep);
+		rows.copyTo(written - keep, output.data() + windowEnd);
+		windowSize = output.size();
+
+		return written;
+	}
+
+	// the next piece starts a new stream (Tight: the server reset its compressor)
+	inline void reset() {
+		output.assign(WINDOW_SIZE, 0);
+		windowSize = WINDOW_SIZE;
+		headerPending = true;
+	}
+};
\ No newline at end of file
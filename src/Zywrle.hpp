@@ -0,0 +1,224 @@
+#pragma once
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define ZYWRLE_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+/**
+ * Inverse transform of ZYWRLE tiles (32 bit pixels), compatible with the encoder of libvncserver.
+ * The server converts a tile to a reversible YUV colour space (Y = (R + 2G + B) / 4, U = (B - G) / 2, V = (R - G) / 2,
+ * one signed byte each in place of blue, green and red), applies `level` steps of a piecewise-linear Haar wavelet to the
+ * largest part of the tile whose sides are multiples of 2^level, quantizes, and sends the subbands (finest first,
+ * the low pass band last) followed by the remaining border pixels unchanged, as the pixels of a ZRLE tile.
+ * The Haar step is its own inverse. With SSE2 it and the conversion back to RGB work on 4 coefficients at a time;
+ * coarser levels are transformed on a dense copy of the coefficients taking part.
+*/
+class Zywrle {
+public:
+	static constexpr size_t MAX_TILE_SIZE = 64;
+
+private:
+	alignas(16) uint32_t coef[MAX_TILE_SIZE * MAX_TILE_SIZE]; // bytes: U, Y, V, unused
+	alignas(16) uint32_t subgrid[MAX_TILE_SIZE * MAX_TILE_SIZE / 4]; // coefficients taking part in a coarser level
+	uint32_t border[MAX_TILE_SIZE * MAX_TILE_SIZE]; // pixels outside the transformed area
+
+	// piecewise-linear Haar step on a pair of signed bytes
+	static inline void haar(uint8_t& x0, uint8_t& x1) {
+		const int a = static_cast<int8_t>(x0);
+		const int b = static_cast<int8_t>(x1);
+		int h = a, l = b;
+		if((a ^ b) & 0x80) { // different signs
+			l = b + a;
+			if(!((l ^ b) & 0x80)) h = a - l;
+		} else {
+			h = a - b;
+			if(!((h ^ a) & 0x80)) l = b + h;
+		}
+		x0 = static_cast<uint8_t>(l);
+		x1 = static_cast<uint8_t>(h);
+	}
+
+	// the three colour bytes of two coefficients
+	static inline void haar(uint32_t& x0, uint32_t& x1) {
+		uint8_t *const a = reinterpret_cast<uint8_t*>(&x0);
+		uint8_t *const b = reinterpret_cast<uint8_t*>(&x1);
+		for(size_t c = 0; c < 3; c++)
+			haar(a[c], b[c]);
+	}
+
+#ifdef ZYWRLE_SSE2
+	// haar() on 16 byte lanes (the unused fourth byte of each coefficient is transformed as well)
+	static inline void haar(__m128i& x0, __m128i& x1) {
+		const __m128i a = x0, b = x1;
+		const __m128i positive = _mm_set1_epi8(-1); // x > -1: sign bit clear
+
+		const __m128i sum = _mm_add_epi8(b, a); // different signs
+		const __m128i keepSum = _mm_cmpgt_epi8(_mm_xor_si128(sum, b), positive);
+		const __m128i diffH = _mm_or_si128(_mm_and_si128(keepSum, _mm_sub_epi8(a, sum)), _mm_andnot_si128(keepSum, a));
+
+		const __m128i diff = _mm_sub_epi8(a, b); // same sign
+		const __m128i keepDiff = _mm_cmpgt_epi8(_mm_xor_si128(diff, a), positive);
+		const __m128i sameL = _mm_or_si128(_mm_and_si128(keepDiff, _mm_add_epi8(b, diff)), _mm_andnot_si128(keepDiff, b));
+
+		const __m128i differ = _mm_cmplt_epi8(_mm_xor_si128(a, b), _mm_setzero_si128());
+		x0 = _mm_or_si128(_mm_and_si128(differ, sum), _mm_andnot_si128(differ, sameL));
+		x1 = _mm_or_si128(_mm_and_si128(differ, diffH), _mm_andnot_si128(differ, diff));
+	}
+#endif
+
+	// one level on a dense grid (16 byte aligned, even width and height): pairs of adjacent rows, then of adjacent columns
+	static inline void inverseStep(uint32_t *const grid, const size_t width, const size_t height) {
+		for(size_t y = 0; y < height; y += 2) {
+			uint32_t *const row0 = grid + y * width;
+			uint32_t *const row1 = row0 + width;
+			size_t x = 0;
+#ifdef ZYWRLE_SSE2
+			for(; x + 4 <= width; x += 4) {
+				__m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(row0 + x)); // y * width is a multiple of 4
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x));
+				haar(a, b);
+				_mm_store_si128(reinterpret_cast<__m128i*>(row0 + x), a);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(row1 + x), b);
+			}
+#endif
+			for(; x < width; x++)
+				haar(row0[x], row1[x]);
+		}
+
+		for(size_t y = 0; y < height; y++) {
+			uint32_t *const row = grid + y * width;
+			size_t x = 0;
+#ifdef ZYWRLE_SSE2
+			for(; x + 8 <= width; x += 8) {
+				const __m128i v0 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x)), _MM_SHUFFLE(3, 1, 2, 0));
+				const __m128i v1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 4)), _MM_SHUFFLE(3, 1, 2, 0));
+				__m128i even = _mm_unpacklo_epi64(v0, v1);
+				__m128i odd = _mm_unpackhi_epi64(v0, v1);
+				haar(even, odd);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), _mm_unpacklo_epi32(even, odd));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(row + x + 4), _mm_unpackhi_epi32(even, odd));
+			}
+#endif
+			for(; x < width; x += 2)
+				haar(row[x], row[x + 1]);
+		}
+	}
+
+	// level l transforms the coefficients at multiples of 2^l like level 0 does a dense grid
+	inline void inverseLevel(const size_t width, const size_t height, const size_t level) {
+		if(level == 0) {
+			inverseStep(coef, width, height);
+			return;
+		}
+
+		const size_t subWidth = width >> level;
+		const size_t subHeight = height >> level;
+		for(size_t y = 0; y < subHeight; y++)
+			for(size_t x = 0; x < subWidth; x++)
+				subgrid[y * subWidth + x] = coef[(y * width + x) << level];
+		inverseStep(subgrid, subWidth, subHeight);
+		for(size_t y = 0; y < subHeight; y++)
+			for(size_t x = 0; x < subWidth; x++)
+				coef[(y * width + x) << level] = subgrid[y * subWidth + x];
+	}
+
+	// coefficients of the transformed area to 32 bit pixels (blue | green << 8 | red << 16)
+	inline void toRGB(uint32_t *const tile, const size_t stride, const size_t width, const size_t height) const {
+#ifdef ZYWRLE_SSE2
+		const __m128i bias = _mm_set1_epi16(128);
+		const __m128i zero = _mm_setzero_si128();
+		// signed byte of each coefficient (selected by shifting it to the top), as 16 bit lanes
+		const auto channel = [](const __m128i lo, const __m128i hi, const int shift) {
+			return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, shift), 24), _mm_srai_epi32(_mm_slli_epi32(hi, shift), 24));
+		};
+#endif
+		for(size_t y = 0; y < height; y++) {
+			const uint32_t *const src = coef + y * width;
+			uint32_t *const dst = tile + y * stride;
+			size_t x = 0;
+#ifdef ZYWRLE_SSE2
+			for(; x + 8 <= width; x += 8) {
+				const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+				const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 4));
+				const __m128i u = _mm_slli_epi16(channel(lo, hi, 24), 1);
+				const __m128i luma = _mm_add_epi16(channel(lo, hi, 16), bias);
+				const __m128i v = _mm_slli_epi16(channel(lo, hi, 8), 1);
+
+				const __m128i g = _mm_sub_epi16(luma, _mm_srai_epi16(_mm_add_epi16(u, v), 2));
+				const __m128i b = _mm_add_epi16(u, g);
+				const __m128i r = _mm_add_epi16(v, g);
+
+				const __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+				const __m128i r0 = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), zero);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_unpacklo_epi16(bg, r0));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 4), _mm_unpackhi_epi16(bg, r0));
+			}
+#endif
+			for(; x < width; x++) {
+				const uint8_t *const c = reinterpret_cast<const uint8_t*>(src + x);
+				const int u = static_cast<int8_t>(c[0]) * 2;
+				const int luma = static_cast<int8_t>(c[1]) + 128;
+				const int v = static_cast<int8_t>(c[2]) * 2;
+				const int g = luma - ((u + v) >> 2);
+				dst[x] = std::clamp(u + g, 0, 255) | std::clamp(g, 0, 255) << 8 | std::clamp(v + g, 0, 255) << 16;
+			}
+		}
+	}
+
+public:
+	// transforms a tile of at most MAX_TILE_SIZE x MAX_TILE_SIZE pixels (as decoded from ZRLE) in place
+	inline void synthesize(uint32_t *const tile, const size_t stride, const size_t tileWidth, const size_t tileHeight, const size_t level) {
+		const size_t width = tileWidth & ~((size_t(1) << level) - 1);
+		const size_t height = tileHeight & ~((size_t(1) << level) - 1);
+		if(level == 0 || width == 0 || height == 0) // sent untransformed
+			return;
+
+		// the coefficients are sent in raster order of the whole tile:
+		size_t readX = 0, readY = 0;
+		const auto next = [&]() {
+			const uint32_t value = tile[readY * stride + readX];
+			if(++readX == tileWidth) {
+				readX = 0;
+				readY++;
+			}
+			return value;
+		};
+
+		// subbands of each level: high pass in both directions, vertically, horizontally; after the last level the low pass band
+		for(size_t l = 0; l < level; l++) {
+			const size_t step = size_t(2) << l;
+			const int lastBand = (l + 1 == level) ? 0 : 1;
+			for(int band = 3; band >= lastBand; band--) {
+				for(size_t y = (band & 2) ? step / 2 : 0; y < height; y += step)
+					for(size_t x = (band & 1) ? step / 2 : 0; x < width; x += step)
+						coef[y * width + x] = next();
+			}
+		}
+
+		// then the border: right of the transformed area, below it, and the corner
+		size_t numBorder = 0;
+		const size_t numBorderPixels = tileWidth * tileHeight - width * height;
+		while(numBorder < numBorderPixels)
+			border[numBorder++] = next();
+
+		for(size_t l = level; l-- > 0; )
+			inverseLevel(width, height, l);
+		toRGB(tile, stride, width, height);
+
+		const uint32_t* src = border;
+		const auto copyBorder = [&](const size_t x0, const size_t x1, const size_t y0, const size_t y1) {
+			for(size_t y = y0; y < y1; y++, src += x1 - x0)
+				std::copy(src, src + (x1 - x0), tile + y * stride + x0);
+		};
+		copyBorder(width, tileWidth, 0, height);
+		copyBorder(0, width, height, tileHeight);
+		copyBorder(width, tileWidth, height, tileHeight);
+	}
+};
\ No newline at end of file
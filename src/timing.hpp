@@ -1,24 +1,59 @@
-#pragma once
-
-
-#include "windows.h"
-
-
-/**
- * gibt die Frequent des Winapi-Performancecounters in Herz zurueck
-*/
-inline size_t queryPerformanceFrequency() {
-	LARGE_INTEGER perfFreq;
-	QueryPerformanceFrequency(&perfFreq);
-	return perfFreq.QuadPart;
-};
-
-
-/**
- * Gibt den aktuellen Wert des Winapi-Performancecounters zurueck. Sollte nur fuer Intervall-messungen verwendet werden
-*/
-inline size_t queryPerformanceCounter() {
-	LARGE_INTEGER perfCount;
-	QueryPerformanceCounter(&perfCount);
-	return perfCount.QuadPart;
+#pragma once
+
+
+#ifdef _WIN32
+	#include "windows.h"
+#else
+	#include <ctime>
+#endif
+
+#include <cstddef>
+
+
+#ifdef _WIN32
+
+/**
+ * gibt die Frequent des Winapi-Performancecounters in Herz zurueck
+*/
+inline size_t queryPerformanceFrequency() {
+	LARGE_INTEGER perfFreq;
+	QueryPerformanceFrequency(&perfFreq);
+	return perfFreq.QuadPart;
+};
+
+
+/**
+ * Gibt den aktuellen Wert des Winapi-Performancecounters zurueck. Sollte nur fuer Intervall-messungen verwendet werden
+*/
+inline size_t queryPerformanceCounter() {
+	LARGE_INTEGER perfCount;
+	QueryPerformanceCounter(&perfCount);
+	return perfCount.QuadPart;
+};
+
+#else
+
+/**
+ * POSIX-Gegenstueck: CLOCK_MONOTONIC in Nanosekunden
+*/
+inline size_t queryPerformanceFrequency() {
+	return 1'000'000'000;
+};
+
+
+inline size_t queryPerformanceCounter() {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return static_cast<size_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+};
+
+#endif
+
+
+/**
+ * Standard-Zeitquelle von BasicVNC (Ticks des Performancecounters)
+*/
+struct PerformanceCounter {
+	inline size_t now() const { return queryPerformanceCounter(); }
+	inline size_t frequency() const { return queryPerformanceFrequency(); }
 };
\ No newline at end of file
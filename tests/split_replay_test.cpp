@@ -0,0 +1,180 @@
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <type_traits>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "VNC.hpp"
+#include "MemoryTransport.hpp"
+#include "EmulatedLink.hpp"
+#include "synthetic_session.hpp"
+
+
+// Replays a synthetic session (all encodings, plus the Cursor pseudo-encoding; 32 and 16 bit pixels) through an EmulatedLink
+// on virtual time (which the client's own timing follows too), with seeded random read sizes down to single bytes. The
+// framebuffer and cursor have to match what the session encoded (within the JPEG error), and come out byte-identical to
+// decoding the same session from one unsplit buffer.
+
+
+// one cell per encoding, in a grid of CELLS_X x CELLS_Y
+static constexpr uint16_t CELL_W = 96;
+static constexpr uint16_t CELL_H = 80;
+static constexpr uint16_t CELLS_X = 5;
+static constexpr uint16_t CELLS_Y = 2;
+static constexpr uint16_t WIDTH = CELL_W * CELLS_X;
+static constexpr uint16_t HEIGHT = CELL_H * CELLS_Y;
+static constexpr size_t NUM_UPDATES = 3;
+
+using VirtualLink = EmulatedLink<MemoryTransport, VirtualLinkClock>; // BasicVNC runs on its clock as well (LinkTime)
+
+
+// NUM_UPDATES updates per encoding (each its own FramebufferUpdate) into the encoding's cell, plus cursor shapes
+SessionBuilder buildSession(const size_t bytesPerPixel, size_t& numMessages) {
+	SessionBuilder s(WIDTH, HEIGHT, bytesPerPixel, true, 7);
+	s.handshake("split");
+
+	std::vector<int32_t> encodings { 0, 1, 2, 4, 5, 6, 7, 15, 16, 17 };
+	numMessages = 0;
+	for(size_t i = 0; i < NUM_UPDATES; i++) {
+		for(size_t cell = 0; cell < encodings.size(); cell++) {
+			const int32_t encoding = encodings[cell];
+			const uint16_t cellX = cell % CELLS_X * CELL_W, cellY = cell / CELLS_X * CELL_H;
+			if(encoding == 17 && bytesPerPixel != 4) // (ZYWRLE: 32 bpp only)
+				continue;
+			numMessages++;
+
+			if(encoding == 7) { // Tight: the whole cell in rects of 40x32 pixels
+				s.update(SessionBuilder::numTiles(CELL_W, CELL_H, 40, 32));
+				s.tightRects(cellX, cellY, CELL_W, CELL_H, 40, 32);
+				continue;
+			}
+
+			s.update(1);
+			const uint16_t x = cellX + s.rng() % 20, y = cellY + s.rng() % 20;
+			const uint16_t w = cellX + CELL_W - x - s.rng() % 10, h = cellY + CELL_H - y - s.rng() % 10;
+			switch(encoding) {
+			case 0:  s.raw(x, y, w, h); break;
+			case 1:  s.copyRect(x, y, w, h, s.rng() % (WIDTH - w + 1), s.rng() % (HEIGHT - h + 1)); break;
+			case 2:  s.rre(x, y, w, h, false); break;
+			case 4:  s.rre(x, y, w, h, true); break;
+			case 5:  s.hextile(x, y, w, h); break;
+			case 6:  s.zlib(x, y, w, h); break;
+			case 15: s.trle(x, y, w, h); break;
+			case 16: s.zrle(x, y, w, h); break;
+			case 17: s.zrle(x, y, w, h, true); break;
+			}
+		}
+
+		s.update(1);
+		numMessages++;
+		s.cursor(5 + s.rng() % 28, 5 + s.rng() % 28);
+	}
+	return s;
+}
+
+
+struct Decoded {
+	std::vector<uint8_t> framebuffer;
+	std::vector<uint32_t> cursor;
+	size_t numMessages = 0;
+};
+
+template<typename Transport, typename Clock = PerformanceCounter, typename... TransportArgs>
+Decoded decode(const size_t numMessages, TransportArgs&&... transportArgs) {
+	BasicVNC<Transport, Clock> vnc(std::forward<TransportArgs>(transportArgs)...);
+
+	Decoded result;
+	while(result.numMessages < numMessages) {
+		const auto summary = vnc.recvUpdates();
+		result.numMessages += summary.numMessages;
+		if(summary.numMessages == 0 && !summary.budgetExhausted) {
+			if constexpr(std::is_same_v<Transport, MemoryTransport>) {
+				throw std::runtime_error("decoding stalled");
+			} else {
+				vnc.transport().clock().advance(std::chrono::milliseconds(1)); // waiting for the link
+			}
+		}
+	}
+
+	result.framebuffer.assign(vnc.pixel_data(), vnc.pixel_data() + size_t(vnc.width()) * vnc.height() * vnc.bytesPerPixel());
+	if(vnc.cursor())
+		result.cursor = vnc.cursor()->pixels;
+	return result;
+}
+
+
+// mismatches of a decoded session against the pixels its builder encoded (the first one described in firstMismatch)
+size_t countMismatches(const Decoded& decoded, const SessionBuilder& session, std::string& firstMismatch) {
+	size_t numMismatches = 0;
+	const auto mismatch = [&](const std::string& what) {
+		if(numMismatches++ == 0)
+			firstMismatch = what;
+	};
+
+	for(size_t p = 0; p < session.expected.size(); p++) {
+		if(session.tolerance[p] == SessionBuilder::UNCHECKED)
+			continue;
+		uint32_t pixel;
+		std::memcpy(&pixel, decoded.framebuffer.data() + p * 4, 4);
+		for(size_t c = 0; c < 3; c++) {
+			const int difference = int(pixel >> 8 * c & 0xFF) - int(session.expected[p] >> 8 * c & 0xFF);
+			if(std::abs(difference) > session.tolerance[p]) {
+				mismatch("pixel (" + std::to_string(p % WIDTH) + ", " + std::to_string(p / WIDTH) + ")");
+				break;
+			}
+		}
+	}
+	if(decoded.cursor != session.expectedCursor)
+		mismatch("cursor");
+	return numMismatches;
+}
+
+
+int main() {
+	bool ok = true;
+	try {
+		for(const size_t bytesPerPixel : { 4, 2 }) {
+			size_t numMessages;
+			const SessionBuilder builder = buildSession(bytesPerPixel, numMessages);
+			const std::vector<uint8_t>& session = builder.bytes;
+			const Decoded reference = decode<MemoryTransport>(numMessages, session);
+
+			std::string firstMismatch;
+			if(const size_t numMismatches = countMismatches(reference, builder, firstMismatch)) {
+				std::cout << "FAIL: " << bytesPerPixel * 8 << " bpp session decodes to " << numMismatches << " unexpected pixels, first: " << firstMismatch << "\n";
+				ok = false;
+			}
+
+			for(const uint32_t maxReadSize : { 1u, 2u, 7u, 100u, 1500u, 65536u }) {
+				for(uint64_t seed = 1; seed <= 3; seed++) {
+					LinkConditions conditions;
+					conditions.maxReadSize = maxReadSize;
+					conditions.seed = seed;
+					if(seed == 3) { // also through a slow link
+						conditions.latencyUs = 2000;
+						conditions.jitterUs = 1000;
+						conditions.bytesPerSecond = 10 * 1024 * 1024;
+					}
+
+					const Decoded split = decode<VirtualLink, LinkTime<VirtualLink>>(numMessages, conditions, session);
+					const bool same = split.framebuffer == reference.framebuffer && split.cursor == reference.cursor;
+					if(!same || countMismatches(split, builder, firstMismatch) != 0) {
+						std::cout << "FAIL: " << bytesPerPixel * 8 << " bpp session, reads of 1 to " << maxReadSize << " bytes, seed " << seed << "\n";
+						ok = false;
+					}
+				}
+			}
+			std::cout << bytesPerPixel * 8 << " bpp session: " << numMessages << " messages, " << session.size() << " bytes\n";
+		}
+	} catch(const std::exception& e) {
+		std::cout << "Exception thrown: " << e.what() << "\n";
+		return 1;
+	}
+
+	std::cout << (ok ? "all splits decode identically, as encoded\n" : "decoding failed\n");
+	return ok ? 0 : 1;
+}
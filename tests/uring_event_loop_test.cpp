@@ -0,0 +1,189 @@
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <memory>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "VNC.hpp"
+#include "UringSocket.hpp"
+#include "EventLoop.hpp"
+#include "synthetic_session.hpp"
+
+
+// Drives a UringSocket connection through an EventLoop against a loopback server that answers every FramebufferUpdateRequest
+// with one update. The requests only reach the server if BasicVNC flushes its messages, and the updates only get decoded if
+// the loop wakes up on the transport's nativeHandle(); the framebuffer then has to match what the server encoded.
+// Exits with SKIPPED (reported as skipped by CTest) where io_uring is not available.
+
+
+static constexpr uint16_t WIDTH = 64;
+static constexpr uint16_t HEIGHT = 48;
+static constexpr size_t NUM_UPDATES = 5;
+static constexpr int SKIPPED = 77;
+
+
+// lets the EventLoop dispatch the connection and counts the FramebufferUpdates it decoded
+struct CountingConnection {
+	BasicVNC<UringSocket>& vnc;
+	size_t numFramebufferUpdates = 0;
+
+	inline auto nativeHandle() const { return vnc.nativeHandle(); }
+
+	inline auto recvUpdates() {
+		const auto summary = vnc.recvUpdates();
+		numFramebufferUpdates += summary.numFramebufferUpdates;
+		return summary;
+	}
+};
+
+void recvAll(const int fd, void *const buffer, const size_t size) {
+	for(size_t received = 0; received < size; ) {
+		const ssize_t len = ::recv(fd, reinterpret_cast<uint8_t*>(buffer) + received, size - received, 0);
+		if(len <= 0)
+			throw std::runtime_error("server: connection closed");
+		received += len;
+	}
+}
+
+void sendAll(const int fd, const std::vector<uint8_t>& bytes) {
+	for(size_t sent = 0; sent < bytes.size(); ) {
+		const ssize_t len = ::send(fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+		if(len <= 0)
+			throw std::runtime_error("server: send failed");
+		sent += len;
+	}
+}
+
+// handshake, then one raw full-screen update per FramebufferUpdateRequest (up to NUM_UPDATES); skips all other client messages
+void serve(const int listener, SessionBuilder& session) {
+	const int fd = accept(listener, nullptr, nullptr);
+	if(fd < 0)
+		return;
+
+	try {
+		session.handshake("uring");
+		sendAll(fd, session.bytes);
+		uint8_t clientInit[12 + 1 + 1]; // version, security type, ClientInit
+		recvAll(fd, clientInit, sizeof(clientInit));
+
+		for(size_t numUpdates = 0; numUpdates < NUM_UPDATES; ) {
+			uint8_t header[4];
+			recvAll(fd, header, 1);
+
+			size_t skip = 0;
+			switch(header[0]) {
+			case 0: skip = 19; break; // SetPixelFormat
+			case 2: // SetEncodings
+				recvAll(fd, header + 1, 3);
+				skip = size_t(header[2] << 8 | header[3]) * 4;
+				break;
+			case 3: { // FramebufferUpdateRequest
+				uint8_t request[9];
+				recvAll(fd, request, sizeof(request));
+				session.bytes.clear();
+				session.update(1);
+				session.raw(0, 0, WIDTH, HEIGHT);
+				sendAll(fd, session.bytes);
+				numUpdates++;
+			} break;
+			case 4: skip = 7; break; // KeyEvent
+			case 5: skip = 5; break; // PointerEvent
+			case 150: skip = 9; break; // EnableContinuousUpdates
+			case 248: // Fence
+				recvAll(fd, header + 1, 3);
+				skip = 4;
+				break;
+			default:
+				throw std::runtime_error("server: unexpected message type " + std::to_string(header[0]));
+			}
+
+			std::vector<uint8_t> ignored(skip);
+			recvAll(fd, ignored.data(), skip);
+			if(header[0] == 248) { // payload
+				recvAll(fd, header, 1);
+				ignored.resize(header[0]);
+				recvAll(fd, ignored.data(), ignored.size());
+			}
+		}
+	} catch(const std::exception& e) {
+		std::cout << e.what() << "\n";
+	}
+
+	uint8_t rest;
+	while(::recv(fd, &rest, 1, 0) > 0) { } // until the client closes
+	::close(fd);
+}
+
+
+int main() {
+	const int listener = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in addr {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t addrLen = sizeof(addr);
+	if(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listener, 1) < 0
+			|| getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &addrLen) < 0) {
+		std::cout << "could not create loopback listener\n";
+		return 1;
+	}
+
+	SessionBuilder session(WIDTH, HEIGHT, 4, false, 3);
+	std::thread server(serve, listener, std::ref(session));
+
+	bool ok = false;
+	try {
+		std::unique_ptr<BasicVNC<UringSocket>> vnc;
+		try {
+			vnc = std::make_unique<BasicVNC<UringSocket>>("127.0.0.1", ntohs(addr.sin_port));
+		} catch(const std::runtime_error& e) {
+			if(std::string(e.what()).find("io_uring") == std::string::npos)
+				throw;
+			std::cout << "skipped: " << e.what() << "\n";
+			::shutdown(listener, SHUT_RDWR); // (unblocks accept())
+			server.join();
+			::close(listener);
+			return SKIPPED;
+		}
+
+		CountingConnection connection { *vnc };
+		EventLoop loop;
+		loop.add(connection);
+
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		for(size_t i = 0; i < NUM_UPDATES && std::chrono::steady_clock::now() < deadline; i++) {
+			vnc->sendUpdateRequest(0, 0, WIDTH, HEIGHT, false);
+			while(connection.numFramebufferUpdates <= i && std::chrono::steady_clock::now() < deadline)
+				loop.poll(100);
+		}
+
+		loop.remove(vnc->nativeHandle());
+		vnc->close();
+		server.join();
+
+		ok = connection.numFramebufferUpdates == NUM_UPDATES;
+		for(size_t p = 0; ok && p < size_t(WIDTH) * HEIGHT; p++) {
+			uint32_t pixel;
+			std::memcpy(&pixel, vnc->pixel_data() + p * 4, 4);
+			ok = (pixel & 0xFFFFFF) == session.expected[p];
+		}
+		std::cout << connection.numFramebufferUpdates << " of " << NUM_UPDATES << " updates decoded through the event loop\n";
+	} catch(const std::exception& e) {
+		std::cout << "Exception thrown: " << e.what() << "\n";
+		return 1; // (the test's timeout ends a server still waiting for the client)
+	}
+
+	::close(listener);
+
+	std::cout << (ok ? "framebuffer matches\n" : "FAIL\n");
+	return ok ? 0 : 1;
+}
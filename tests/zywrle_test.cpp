@@ -0,0 +1,159 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "Zywrle.hpp"
+
+
+// Inverse ZYWRLE transform: tiles of known coefficients have to synthesize to known pixels, and tiles transformed the way
+// libvncserver's encoder does it have to come back within the rounding of its colour space conversion.
+
+
+static bool ok = true;
+
+void check(const bool condition, const std::string& what) {
+	if(!condition) {
+		std::cout << "FAIL: " << what << "\n";
+		ok = false;
+	}
+}
+
+// coefficient pixel: bytes U, Y, V (signed)
+uint32_t coefficient(const int y, const int u, const int v) {
+	return uint8_t(u) | uint8_t(y) << 8 | uint8_t(v) << 16;
+}
+
+
+// ---- forward transform of the server (libvncserver zywrle.h, without quantization filter) ----
+
+// piecewise-linear Haar step on a pair of signed bytes (its own inverse)
+void haar(uint8_t& x0, uint8_t& x1) {
+	const int a = int8_t(x0), b = int8_t(x1);
+	int h = a, l = b;
+	if((a ^ b) & 0x80) {
+		l = b + a;
+		if(!((l ^ b) & 0x80)) h = a - l;
+	} else {
+		h = a - b;
+		if(!((h ^ a) & 0x80)) l = b + h;
+	}
+	x0 = uint8_t(l);
+	x1 = uint8_t(h);
+}
+
+void haar(uint32_t& x0, uint32_t& x1) {
+	uint8_t *const a = reinterpret_cast<uint8_t*>(&x0);
+	uint8_t *const b = reinterpret_cast<uint8_t*>(&x1);
+	for(size_t c = 0; c < 3; c++)
+		haar(a[c], b[c]);
+}
+
+// the tile's pixels replaced by what the server sends for it
+void analyze(std::vector<uint32_t>& tile, const size_t tileWidth, const size_t tileHeight, const size_t level) {
+	const size_t width = tileWidth & ~((size_t(1) << level) - 1);
+	const size_t height = tileHeight & ~((size_t(1) << level) - 1);
+	if(width == 0 || height == 0) // sent untransformed
+		return;
+
+	std::vector<uint32_t> coef(width * height);
+	for(size_t y = 0; y < height; y++) {
+		for(size_t x = 0; x < width; x++) {
+			const uint32_t pixel = tile[y * tileWidth + x];
+			const int r = pixel >> 16 & 0xFF, g = pixel >> 8 & 0xFF, b = pixel & 0xFF;
+			coef[y * width + x] = coefficient(((r + 2 * g + b) >> 2) - 128, (b - g) >> 1, (r - g) >> 1);
+		}
+	}
+
+	for(size_t l = 0; l < level; l++) {
+		const size_t half = size_t(1) << l, step = half * 2;
+		for(size_t y = 0; y < height; y += half) // rows
+			for(size_t x = 0; x < width; x += step)
+				haar(coef[y * width + x], coef[y * width + x + half]);
+		for(size_t x = 0; x < width; x += half) // columns
+			for(size_t y = 0; y < height; y += step)
+				haar(coef[y * width + x], coef[(y + half) * width + x]);
+	}
+
+	std::vector<uint32_t> sent;
+	for(size_t l = 0; l < level; l++) { // per level the high pass bands, after the last one the low pass band
+		const size_t step = size_t(2) << l;
+		for(int band = 3; band >= ((l + 1 == level) ? 0 : 1); band--)
+			for(size_t y = (band & 2) ? step / 2 : 0; y < height; y += step)
+				for(size_t x = (band & 1) ? step / 2 : 0; x < width; x += step)
+					sent.push_back(coef[y * width + x]);
+	}
+	for(size_t y = 0; y < height; y++) // border: right of the transformed area, below it, the corner
+		for(size_t x = width; x < tileWidth; x++)
+			sent.push_back(tile[y * tileWidth + x]);
+	for(size_t y = height; y < tileHeight; y++)
+		for(size_t x = 0; x < width; x++)
+			sent.push_back(tile[y * tileWidth + x]);
+	for(size_t y = height; y < tileHeight; y++)
+		for(size_t x = width; x < tileWidth; x++)
+			sent.push_back(tile[y * tileWidth + x]);
+
+	tile = sent;
+}
+
+
+int main() {
+	Zywrle zywrle;
+
+	// low pass band only (R 200, G 100, B 50 -> Y -16, U -25, V 50): every pixel of the transformed area gets that colour;
+	// the border column, row and corner of the 5x5 tile are copied
+	{
+		std::vector<uint32_t> tile(5 * 5, 0);
+		tile[15] = coefficient(-16, -25, 50); // 16th value sent: the low pass band of level 2
+		for(size_t i = 0; i < 9; i++)
+			tile[16 + i] = 0x010203 * (i + 1);
+
+		zywrle.synthesize(tile.data(), 5, 5, 5, 2);
+		for(size_t y = 0; y < 4; y++)
+			for(size_t x = 0; x < 4; x++)
+				check((tile[y * 5 + x] & 0xFFFFFF) == 0xC86432, "low pass band at (" + std::to_string(x) + ", " + std::to_string(y) + ")");
+		for(size_t y = 0; y < 4; y++)
+			check(tile[y * 5 + 4] == 0x010203 * (y + 1), "right border, row " + std::to_string(y));
+		for(size_t x = 0; x < 4; x++)
+			check(tile[4 * 5 + x] == 0x010203 * (x + 5), "bottom border, column " + std::to_string(x));
+		check(tile[24] == 0x010203 * 9, "border corner");
+	}
+
+	// one level on 2x2 pixels: high pass bands (both, vertical, horizontal), then the low pass band; grey levels (U = V = 0)
+	{
+		std::vector<uint32_t> tile { coefficient(0, 0, 0), coefficient(-4, 0, 0), coefficient(8, 0, 0), coefficient(-28, 0, 0) };
+		zywrle.synthesize(tile.data(), 2, 2, 2, 1);
+		const uint32_t expected[4] { 0x6C6C6C, 0x646464, 0x707070, 0x686868 }; // 108, 100 / 112, 104
+		for(size_t i = 0; i < 4; i++)
+			check((tile[i] & 0xFFFFFF) == expected[i], "2x2 tile, pixel " + std::to_string(i));
+	}
+
+	// round trips of smooth tiles of all sizes (the colour space conversion rounds by up to 2 per component;
+	// steep edges would saturate the piecewise-linear Haar steps, which the server accepts as loss)
+	std::mt19937 rng(1);
+	for(size_t t = 0; t < 2000; t++) {
+		const size_t width = 1 + rng() % Zywrle::MAX_TILE_SIZE, height = 1 + rng() % Zywrle::MAX_TILE_SIZE, level = 1 + rng() % 3;
+		const size_t slopeX = rng() % 4, slopeY = rng() % 4, offset = rng() % 256;
+		std::vector<uint32_t> original(width * height);
+		for(size_t y = 0; y < height; y++)
+			for(size_t x = 0; x < width; x++)
+				original[y * width + x] = std::min<size_t>(x * slopeX + y + offset, 255) << 16 | std::min<size_t>(y * slopeY + offset / 2, 255) << 8 | (x + rng() % 16);
+
+		std::vector<uint32_t> tile = original;
+		analyze(tile, width, height, level);
+		zywrle.synthesize(tile.data(), width, width, height, level);
+
+		int maxError = 0;
+		for(size_t i = 0; i < tile.size(); i++)
+			for(size_t c = 0; c < 24; c += 8)
+				maxError = std::max(maxError, std::abs(int(tile[i] >> c & 0xFF) - int(original[i] >> c & 0xFF)));
+		check(maxError <= 2, "round trip of a " + std::to_string(width) + "x" + std::to_string(height) + " tile at level "
+			+ std::to_string(level) + ": error " + std::to_string(maxError));
+	}
+
+	std::cout << (ok ? "all tiles synthesize as expected\n" : "synthesis failed\n");
+	return ok ? 0 : 1;
+}